@@ -0,0 +1,4 @@
+# pos-config.cmake — find_package(pos) for services linking libpos
+include(CMakeFindDependencyMacro)
+find_dependency(Threads)
+include("${CMAKE_CURRENT_LIST_DIR}/pos-targets.cmake")
@@ -0,0 +1,42 @@
+#!/bin/sh
+# pgo-build.sh — Reproducible profile-guided build of pos_modern / pos_bench
+#
+#   scripts/pgo-build.sh [BUILD_DIR]          (default: build-pgo)
+#
+# 1. Configure with -DPOS_PGO=GENERATE and build instrumented binaries.
+# 2. Run the built-in training workload (pos_modern --train).
+# 3. Reconfigure with -DPOS_PGO=USE and rebuild with the recorded profile.
+# 4. If llvm-bolt is on PATH, instrument the PGO binary, rerun the training
+#    workload, and write an additionally layout-optimized pos_modern.bolt.
+#
+# Extra CMake arguments can be passed through CMAKE_ARGS.
+set -eu
+
+src_dir=$(cd "$(dirname "$0")/.." && pwd)
+build_dir=${1:-build-pgo}
+profile_dir="$(cd "$(dirname "$build_dir")" && pwd)/$(basename "$build_dir")/pgo-profiles"
+
+rm -rf "$profile_dir"
+
+cmake -S "$src_dir" -B "$build_dir" -DCMAKE_BUILD_TYPE=Release \
+      -DPOS_PGO=GENERATE -DPOS_PGO_DIR="$profile_dir" ${CMAKE_ARGS:-}
+cmake --build "$build_dir" --target pgo-train
+
+bolt=OFF
+command -v llvm-bolt >/dev/null 2>&1 && bolt=ON
+
+cmake -S "$src_dir" -B "$build_dir" -DPOS_PGO=USE -DPOS_BOLT=$bolt
+cmake --build "$build_dir" --clean-first
+
+if [ "$bolt" = ON ]; then
+    bin="$build_dir/pos_modern"
+    fdata="$build_dir/pos_modern.fdata"
+    llvm-bolt "$bin" -instrument -instrumentation-file="$fdata" -o "$bin.inst"
+    "$bin.inst" --train >/dev/null
+    llvm-bolt "$bin" -data="$fdata" -o "$bin.bolt" \
+        -reorder-blocks=ext-tsp -reorder-functions=hfsort -split-functions \
+        -split-all-cold -icf=1 -dyno-stats
+    echo "BOLT-optimized binary: $bin.bolt"
+fi
+
+echo "PGO build complete in $build_dir"
@@ -0,0 +1,131 @@
+#!/usr/bin/env python3
+# verify-exports.py — Round-trip check of the Arrow, Parquet, CSV and NDJSON writers
+#
+#   scripts/verify-exports.py PATH/TO/pos_bench      (ctest: export_roundtrip)
+#
+# Runs `pos_bench --verify DIR`, decodes verify.bin with struct as the
+# reference, and reads the other files back with pyarrow, csv and json:
+# every value of every column must match, as must the Arrow batch / Parquet
+# row group boundaries and the Parquet min/max statistics. pyarrow is the
+# only dependency; without it the check is skipped (exit 77).
+import csv
+import json
+import struct
+import subprocess
+import sys
+import tempfile
+from decimal import Decimal
+from pathlib import Path
+
+try:
+    import pyarrow
+    import pyarrow.ipc
+    import pyarrow.parquet
+except ImportError:
+    print("pyarrow not installed; skipping")
+    sys.exit(77)
+
+COLUMNS = ["txnId", "amountCents", "storeNumber", "pumpNumber", "cardType"]
+
+
+def reference(path):
+    """The records of verify.bin as column lists; cardType decoded as Latin-1."""
+    cols = {c: [] for c in COLUMNS}
+    for rec in struct.iter_unpack(">IIHH4s", path.read_bytes()):
+        for c, v in zip(COLUMNS, rec):
+            cols[c].append(v.decode("latin-1") if c == "cardType" else v)
+    return cols
+
+
+def check_table(name, table, want, failures):
+    try:
+        table.validate(full=True)   # includes UTF-8 validity of cardType
+    except pyarrow.ArrowInvalid as e:
+        failures.append(f"{name}: {e}")
+        return
+    for c in COLUMNS:
+        got = table.column(c).to_pylist()
+        if got != want[c]:
+            i = next((i for i, (g, w) in enumerate(zip(got, want[c])) if g != w), min(len(got), len(want[c])))
+            failures.append(f"{name} {c}: row {i} is {got[i:i + 1]}, expected {want[c][i:i + 1]}"
+                            f" ({len(got)} rows, expected {len(want[c])})")
+
+
+def check_parquet_statistics(pf, want, failures):
+    start = 0
+    for g in range(pf.metadata.num_row_groups):
+        rg = pf.metadata.row_group(g)
+        rows = slice(start, start + rg.num_rows)
+        for i, c in enumerate(COLUMNS):
+            stats = rg.column(i).statistics
+            values = want[c][rows]
+            if c == "cardType":   # bytewise order of the UTF-8 encoding
+                values = sorted(values, key=lambda s: s.encode("utf-8"))
+                expect = (values[0], values[-1])
+            else:
+                expect = (min(values), max(values))
+            if (stats.min, stats.max) != expect:
+                failures.append(f"parquet row group {g} {c}: min/max {stats.min!r}/{stats.max!r},"
+                                f" expected {expect[0]!r}/{expect[1]!r}")
+        start += rg.num_rows
+
+
+def text_rows(want):
+    """The rows the text formats should hold: amount in dollars, cardType without trailing blanks."""
+    for i in range(len(want["txnId"])):
+        yield (want["txnId"][i], Decimal(want["amountCents"][i]) / 100, want["storeNumber"][i],
+               want["pumpNumber"][i], want["cardType"][i].rstrip(" "))
+
+
+def check_csv(path, want, failures):
+    with path.open(newline="", encoding="latin-1") as f:
+        reader = csv.reader(f)
+        if next(reader) != ["txnId", "amount", "storeNumber", "pumpNumber", "cardType"]:
+            failures.append("csv: unexpected header")
+        got = [(int(r[0]), Decimal(r[1]), int(r[2]), int(r[3]), r[4]) for r in reader]
+    if got != list(text_rows(want)):
+        failures.append("csv: rows differ from verify.bin")
+
+
+def check_ndjson(path, want, failures):
+    got = []
+    for line in path.read_text(encoding="ascii").splitlines():
+        o = json.loads(line, parse_float=Decimal)
+        got.append((o["txnId"], Decimal(o["amount"]), o["storeNumber"], o["pumpNumber"], o["cardType"]))
+    if got != list(text_rows(want)):
+        failures.append("ndjson: rows differ from verify.bin")
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(f"usage: {sys.argv[0]} PATH/TO/pos_bench", file=sys.stderr)
+        return 2
+    with tempfile.TemporaryDirectory() as tmp:
+        d = Path(tmp)
+        subprocess.run([sys.argv[1], "--verify", tmp], check=True)
+        want = reference(d / "verify.bin")
+        failures = []
+
+        with pyarrow.ipc.open_stream(d / "verify.arrows") as reader:
+            batches = list(reader)
+        check_table("arrow", pyarrow.Table.from_batches(batches), want, failures)
+
+        pf = pyarrow.parquet.ParquetFile(d / "verify.parquet")
+        check_table("parquet", pf.read(), want, failures)
+        check_parquet_statistics(pf, want, failures)
+        groups = [pf.metadata.row_group(g).num_rows for g in range(pf.metadata.num_row_groups)]
+        if groups != [len(b) for b in batches]:
+            failures.append(f"parquet row groups {groups} differ from the arrow batches")
+
+        check_csv(d / "verify.csv", want, failures)
+        check_ndjson(d / "verify.ndjson", want, failures)
+
+    for f in failures:
+        print("FAIL", f)
+    print(f"{len(want['txnId'])} records in {len(groups)} groups: "
+          + ("all formats match" if not failures else f"{len(failures)} mismatches"))
+    return 1 if failures else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
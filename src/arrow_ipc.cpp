@@ -0,0 +1,381 @@
+// arrow_ipc.cpp — Arrow IPC stream writer and C Data Interface export
+//
+// IPC metadata is FlatBuffers (Arrow's format/Message.fbs, Schema.fbs).
+// FlatBuilder writes the few tables this needs front to back: a table's
+// vtable directly before it, children after their parent, and each
+// forward offset patched once the child's position is known.
+
+#include "arrow_ipc.h"
+
+#include <algorithm>
+#include <bit>
+#include <initializer_list>
+#include <iterator>
+#include <string_view>
+
+#include "ebcdic.h"
+#include "txn_batch.h"
+
+namespace {
+
+// ---------------------------------------------------------------------------
+// FlatBuffers, write-only and forward
+// ---------------------------------------------------------------------------
+
+class FlatBuilder {
+public:
+    /** Slot — One table field: a scalar value, or an offset patched later. */
+    struct Slot {
+        uint16_t     id;
+        uint8_t      size;           // 1, 2, 4 or 8 bytes
+        uint64_t     value = 0;
+        std::size_t* offsetAt = nullptr;   // set: a uoffset, position returned here
+    };
+
+    FlatBuilder() { put<uint32_t>(0); }    // root offset, patched by root()
+
+    const std::vector<uint8_t>& bytes() const { return buf_; }
+
+    /** root — Make the table at `table` the buffer's root. */
+    void root(std::size_t table) { patch(0, table); }
+
+    /** patch — Point the uoffset at `at` to the later position `target`. */
+    void patch(std::size_t at, std::size_t target) {
+        putAt<uint32_t>(at, static_cast<uint32_t>(target - at));
+    }
+
+    /** table — Write a vtable and its table (8-byte aligned); returns the table. */
+    std::size_t table(std::initializer_list<Slot> slots) {
+        uint16_t fieldOffset[16] = {};
+        uint16_t slotCount = 0;
+        uint16_t size = 4;                                  // soffset to the vtable
+        for (uint8_t width : {8, 4, 2, 1})
+            for (const Slot& s : slots)
+                if (s.size == width) {
+                    size = static_cast<uint16_t>((size + width - 1) / width * width);
+                    fieldOffset[s.id] = size;
+                    size = static_cast<uint16_t>(size + width);
+                    slotCount = std::max<uint16_t>(slotCount, s.id + 1);
+                }
+        const std::size_t vtableBytes = 4 + 2 * std::size_t{slotCount};
+
+        pad(2);
+        while ((buf_.size() + vtableBytes) % 8) put<uint16_t>(0);
+        const std::size_t vtable = buf_.size();
+        put<uint16_t>(static_cast<uint16_t>(vtableBytes));
+        put<uint16_t>(size);
+        for (uint16_t id = 0; id < slotCount; ++id) put<uint16_t>(fieldOffset[id]);
+
+        const std::size_t table = buf_.size();
+        buf_.resize(table + size, 0);
+        putAt<int32_t>(table, static_cast<int32_t>(table - vtable));
+        for (const Slot& s : slots) {
+            const std::size_t at = table + fieldOffset[s.id];
+            if (s.offsetAt) *s.offsetAt = at;
+            else putAtWidth(at, s.value, s.size);
+        }
+        return table;
+    }
+
+    /**
+     * vector — A vector of `count` elements of `elemSize` bytes, aligned to
+     * `align`; returns the length field (what offsets point to). Elements
+     * start 4 bytes later and are written by the caller.
+     */
+    std::size_t vector(std::size_t count, std::size_t elemSize, std::size_t align) {
+        pad(4);
+        while ((buf_.size() + 4) % align) put<uint32_t>(0);
+        const std::size_t at = buf_.size();
+        put<uint32_t>(static_cast<uint32_t>(count));
+        buf_.resize(buf_.size() + count * elemSize, 0);
+        return at;
+    }
+
+    /** string — A NUL-terminated string; returns its length field. */
+    std::size_t string(std::string_view s) {
+        pad(4);
+        const std::size_t at = buf_.size();
+        put<uint32_t>(static_cast<uint32_t>(s.size()));
+        buf_.insert(buf_.end(), s.begin(), s.end());
+        buf_.push_back(0);
+        return at;
+    }
+
+    /** putAt — Little-endian scalar at `at` (FlatBuffers are little-endian). */
+    template <typename T>
+    void putAt(std::size_t at, T v) { putAtWidth(at, static_cast<uint64_t>(v), sizeof(T)); }
+
+private:
+    template <typename T>
+    void put(T v) {
+        buf_.resize(buf_.size() + sizeof(T));
+        putAt(buf_.size() - sizeof(T), v);
+    }
+
+    void putAtWidth(std::size_t at, uint64_t v, std::size_t width) {
+        for (std::size_t k = 0; k < width; ++k, v >>= 8) buf_[at + k] = static_cast<uint8_t>(v);
+    }
+
+    void pad(std::size_t align) {
+        while (buf_.size() % align) buf_.push_back(0);
+    }
+
+    std::vector<uint8_t> buf_;
+};
+
+// Message.fbs / Schema.fbs constants
+constexpr uint16_t kMetadataV5          = 4;
+constexpr uint8_t  kHeaderSchema        = 1;
+constexpr uint8_t  kHeaderRecordBatch   = 3;
+constexpr uint8_t  kTypeInt             = 2;
+constexpr uint8_t  kTypeUtf8            = 5;
+constexpr uint16_t kEndianness = std::endian::native == std::endian::little ? 0 : 1;
+
+struct ColumnInfo {
+    const char* name;
+    uint8_t     bitWidth;       // 0 = utf8
+    const char* cFormat;        // C Data Interface format string
+};
+
+constexpr ColumnInfo kColumns[] = {
+    {"txnId", 32, "I"}, {"amountCents", 32, "I"}, {"storeNumber", 16, "S"},
+    {"pumpNumber", 16, "S"}, {"cardType", 0, "u"},
+};
+constexpr std::size_t kColumnCount = std::size(kColumns);
+
+/** schemaMessage — The Message{Schema} flatbuffer of kColumns. */
+std::vector<uint8_t> schemaMessage() {
+    FlatBuilder fb;
+    std::size_t headerAt, fieldsAt;
+    fb.root(fb.table({{0, 2, kMetadataV5}, {1, 1, kHeaderSchema}, {2, 4, 0, &headerAt},
+                      {3, 8, 0}}));
+    fb.patch(headerAt, fb.table({{0, 2, kEndianness}, {1, 4, 0, &fieldsAt}}));
+    const std::size_t fields = fb.vector(kColumnCount, 4, 4);
+    fb.patch(fieldsAt, fields);
+
+    for (std::size_t c = 0; c < kColumnCount; ++c) {
+        const ColumnInfo& col = kColumns[c];
+        std::size_t nameAt, typeAt, childrenAt;
+        const uint8_t typeType = col.bitWidth ? kTypeInt : kTypeUtf8;
+        fb.patch(fields + 4 + 4 * c,
+                 fb.table({{0, 4, 0, &nameAt}, {1, 1, 0}, {2, 1, typeType}, {3, 4, 0, &typeAt},
+                           {5, 4, 0, &childrenAt}}));
+        fb.patch(nameAt, fb.string(col.name));
+        fb.patch(typeAt, col.bitWidth ? fb.table({{0, 4, col.bitWidth}, {1, 1, 0}})
+                                      : fb.table({}));
+        fb.patch(childrenAt, fb.vector(0, 4, 4));
+    }
+    return fb.bytes();
+}
+
+/** BodyBuffer — One buffer of a record batch body. */
+struct BodyBuffer {
+    const void* data;
+    std::size_t length;
+};
+
+/** batchBuffers — The batch's buffers in IPC order (validity buffers empty). */
+std::vector<BodyBuffer> batchBuffers(const TxnArrowBatch& b) {
+    const std::size_t n = b.length();
+    return {{nullptr, 0}, {b.txnId(), n * 4},
+            {nullptr, 0}, {b.amountCents(), n * 4},
+            {nullptr, 0}, {b.storeNumber(), n * 2},
+            {nullptr, 0}, {b.pumpNumber(), n * 2},
+            {nullptr, 0}, {b.cardOffsets(), (n + 1) * 4}, {b.cardType(), b.cardBytes()}};
+}
+
+constexpr std::size_t padded8(std::size_t n) { return (n + 7) & ~std::size_t{7}; }
+
+/** recordBatchMessage — The Message{RecordBatch} flatbuffer for `buffers`. */
+std::vector<uint8_t> recordBatchMessage(std::size_t length, const std::vector<BodyBuffer>& buffers) {
+    std::size_t bodyLength = 0;
+    for (const BodyBuffer& b : buffers) bodyLength += padded8(b.length);
+
+    FlatBuilder fb;
+    std::size_t headerAt, nodesAt, buffersAt;
+    fb.root(fb.table({{0, 2, kMetadataV5}, {1, 1, kHeaderRecordBatch}, {2, 4, 0, &headerAt},
+                      {3, 8, bodyLength}}));
+    fb.patch(headerAt, fb.table({{0, 8, length}, {1, 4, 0, &nodesAt}, {2, 4, 0, &buffersAt}}));
+
+    const std::size_t nodes = fb.vector(kColumnCount, 16, 8);      // struct FieldNode
+    fb.patch(nodesAt, nodes);
+    for (std::size_t c = 0; c < kColumnCount; ++c) {
+        fb.putAt<uint64_t>(nodes + 4 + 16 * c, length);                // length
+        fb.putAt<uint64_t>(nodes + 4 + 16 * c + 8, 0);                 // null_count
+    }
+    const std::size_t table = fb.vector(buffers.size(), 16, 8);    // struct Buffer
+    fb.patch(buffersAt, table);
+    std::size_t offset = 0;
+    for (std::size_t i = 0; i < buffers.size(); ++i) {
+        fb.putAt<uint64_t>(table + 4 + 16 * i, offset);
+        fb.putAt<uint64_t>(table + 4 + 16 * i + 8, buffers[i].length);
+        offset += padded8(buffers[i].length);
+    }
+    return fb.bytes();
+}
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// TxnArrowBatch
+// ---------------------------------------------------------------------------
+
+TxnArrowBatch::TxnArrowBatch(std::size_t capacity)
+    : txnId_(capacity), amountCents_(capacity), storeNumber_(capacity), pumpNumber_(capacity),
+      cardOffsets_(capacity + 1), cardType_(capacity * 4) {
+    for (std::size_t i = 0; i <= capacity; ++i) cardOffsets_[i] = static_cast<int32_t>(i * 4);
+}
+
+void TxnArrowBatch::decode(const char* raw, std::size_t count) {
+    length_ = std::min(count, capacity());
+    decodeColumns(raw, length_, {txnId_.data(), amountCents_.data(), storeNumber_.data(),
+                                 pumpNumber_.data(), cardType_.data()});
+
+    // Card types are nearly always ASCII, which is already UTF-8
+    unsigned high = 0;
+    for (std::size_t i = 0; i < length_ * 4; ++i) high |= static_cast<unsigned char>(cardType_[i]);
+    latin1_ = high & 0x80;
+    if (!latin1_) return;
+    if (utf8_.empty()) {
+        utf8_.resize(capacity() * 8);
+        utf8Offsets_.resize(capacity() + 1);
+    }
+    std::size_t at = 0;
+    for (std::size_t i = 0; i < length_; ++i) {
+        at += latin1ToUtf8(&cardType_[i * 4], 4, &utf8_[at]);
+        utf8Offsets_[i + 1] = static_cast<int32_t>(at);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// ArrowIpcWriter
+// ---------------------------------------------------------------------------
+
+ArrowIpcWriter::ArrowIpcWriter(std::ostream& out) : out_(out) {
+    writeMessage(schemaMessage());
+}
+
+ArrowIpcWriter::~ArrowIpcWriter() {
+    if (!finished_) finish();
+}
+
+void ArrowIpcWriter::writeMessage(const std::vector<uint8_t>& metadata) {
+    // Encapsulated message: continuation, metadata size, metadata padded so
+    // the body starts 8-byte aligned
+    const std::size_t padded = padded8(metadata.size());
+    uint8_t prefix[8] = {0xFF, 0xFF, 0xFF, 0xFF};
+    for (std::size_t k = 0; k < 4; ++k) prefix[4 + k] = static_cast<uint8_t>(padded >> (8 * k));
+    static const char kZeros[8] = {};
+    out_.write(reinterpret_cast<const char*>(prefix), 8);
+    out_.write(reinterpret_cast<const char*>(metadata.data()), static_cast<std::streamsize>(metadata.size()));
+    out_.write(kZeros, static_cast<std::streamsize>(padded - metadata.size()));
+    bytes_ += 8 + padded;
+}
+
+void ArrowIpcWriter::write(const TxnArrowBatch& batch) {
+    const std::vector<BodyBuffer> buffers = batchBuffers(batch);
+    writeMessage(recordBatchMessage(batch.length(), buffers));
+    static const char kZeros[8] = {};
+    for (const BodyBuffer& b : buffers) {
+        if (b.length) out_.write(static_cast<const char*>(b.data), static_cast<std::streamsize>(b.length));
+        out_.write(kZeros, static_cast<std::streamsize>(padded8(b.length) - b.length));
+        bytes_ += padded8(b.length);
+    }
+}
+
+bool ArrowIpcWriter::finish() {
+    if (!finished_) {
+        static const char kEndOfStream[8] = {'\xFF', '\xFF', '\xFF', '\xFF', 0, 0, 0, 0};
+        out_.write(kEndOfStream, 8);
+        bytes_ += 8;
+        finished_ = true;
+    }
+    out_.flush();
+    return static_cast<bool>(out_);
+}
+
+// ---------------------------------------------------------------------------
+// C Data Interface
+//
+// Children may be moved out and released on their own (the specification
+// allows it), so every child owns what it points to: child schemas only
+// point at string literals, and each child array holds its own reference
+// to the batch and its own buffer-pointer array.
+// ---------------------------------------------------------------------------
+
+namespace {
+
+struct SchemaHolder {
+    ArrowSchema  children[kColumnCount];
+    ArrowSchema* childPtrs[kColumnCount];
+};
+
+void releaseChildSchema(ArrowSchema* schema) { schema->release = nullptr; }
+
+void releaseSchema(ArrowSchema* schema) {
+    auto* holder = static_cast<SchemaHolder*>(schema->private_data);
+    for (ArrowSchema& child : holder->children)
+        if (child.release) child.release(&child);
+    delete holder;
+    schema->release = nullptr;
+}
+
+struct ChildArrayHolder {
+    std::shared_ptr<const TxnArrowBatch> batch;
+    const void*                          buffers[3] = {};
+};
+
+struct ArrayHolder {
+    std::shared_ptr<const TxnArrowBatch> batch;
+    const void*                          buffers[1] = {nullptr};   // no validity bitmap
+    ArrowArray                           children[kColumnCount];
+    ArrowArray*                          childPtrs[kColumnCount];
+};
+
+void releaseChildArray(ArrowArray* array) {
+    delete static_cast<ChildArrayHolder*>(array->private_data);
+    array->release = nullptr;
+}
+
+void releaseArray(ArrowArray* array) {
+    auto* holder = static_cast<ArrayHolder*>(array->private_data);
+    for (ArrowArray& child : holder->children)
+        if (child.release) child.release(&child);
+    delete holder;
+    array->release = nullptr;
+}
+
+}  // namespace
+
+void exportTxnSchema(ArrowSchema* out) {
+    auto* holder = new SchemaHolder;
+    for (std::size_t c = 0; c < kColumnCount; ++c) {
+        holder->children[c] = ArrowSchema{kColumns[c].cFormat, kColumns[c].name, nullptr, 0, 0,
+                                          nullptr, nullptr, releaseChildSchema, nullptr};
+        holder->childPtrs[c] = &holder->children[c];
+    }
+    *out = ArrowSchema{"+s", "", nullptr, 0, static_cast<int64_t>(kColumnCount),
+                       holder->childPtrs, nullptr, releaseSchema, holder};
+}
+
+void exportTxnBatch(std::shared_ptr<const TxnArrowBatch> batch, ArrowArray* out) {
+    const auto length = static_cast<int64_t>(batch->length());
+    const void* const data[kColumnCount][2] = {
+        {batch->txnId(), nullptr}, {batch->amountCents(), nullptr},
+        {batch->storeNumber(), nullptr}, {batch->pumpNumber(), nullptr},
+        {batch->cardOffsets(), batch->cardType()}};
+
+    auto* holder = new ArrayHolder;
+    for (std::size_t c = 0; c < kColumnCount; ++c) {
+        auto* child = new ChildArrayHolder{batch};
+        child->buffers[1] = data[c][0];
+        child->buffers[2] = data[c][1];
+        const int64_t nBuffers = kColumns[c].bitWidth ? 2 : 3;
+        holder->children[c] = ArrowArray{length, 0, 0, nBuffers, 0, child->buffers, nullptr,
+                                         nullptr, releaseChildArray, child};
+        holder->childPtrs[c] = &holder->children[c];
+    }
+    holder->batch = std::move(batch);
+    *out = ArrowArray{length, 0, 0, 1, static_cast<int64_t>(kColumnCount), holder->buffers,
+                      holder->childPtrs, nullptr, releaseArray, holder};
+}
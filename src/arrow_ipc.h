@@ -0,0 +1,154 @@
+// arrow_ipc.h — Decoded TxnRecords as Apache Arrow record batches
+//
+// Analytics tools read Arrow directly, so decoded exports are handed over
+// in Arrow's columnar layout instead of as text. One record batch has five
+// non-nullable columns:
+//
+//   txnId        uint32          amountCents  uint32
+//   storeNumber  uint16          pumpNumber   uint16
+//   cardType     utf8 (the 4 Latin-1 bytes on disk, blank padded; bytes
+//                above 0x7F are transcoded, so such values are longer)
+//
+// TxnArrowBatch owns the column buffers and fills them with decodeColumns
+// (txn_batch.h), which decodes and transposes in one pass — the buffers
+// Arrow sees are the ones the kernel wrote. Two ways out:
+//
+//   ArrowIpcWriter    the Arrow IPC streaming format (schema message, one
+//                     message per record batch, end-of-stream marker), as
+//                     read by pyarrow.ipc.open_stream and friends
+//   exportTxnSchema / exportTxnBatch
+//                     the Arrow C Data Interface, for in-process consumers;
+//                     the exported arrays share the batch's buffers and keep
+//                     it alive until the consumer releases them
+//
+// Neither needs the Arrow library: the IPC metadata is written as the
+// FlatBuffers the format specifies, by a small builder in arrow_ipc.cpp.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+// Arrow C Data Interface — the ABI from the Arrow specification, verbatim
+#ifndef ARROW_C_DATA_INTERFACE
+#define ARROW_C_DATA_INTERFACE
+
+#define ARROW_FLAG_DICTIONARY_ORDERED 1
+#define ARROW_FLAG_NULLABLE 2
+#define ARROW_FLAG_MAP_KEYS_SORTED 4
+
+struct ArrowSchema {
+    // Array type description
+    const char* format;
+    const char* name;
+    const char* metadata;
+    int64_t flags;
+    int64_t n_children;
+    struct ArrowSchema** children;
+    struct ArrowSchema* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowSchema*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+struct ArrowArray {
+    // Array data description
+    int64_t length;
+    int64_t null_count;
+    int64_t offset;
+    int64_t n_buffers;
+    int64_t n_children;
+    const void** buffers;
+    struct ArrowArray** children;
+    struct ArrowArray* dictionary;
+
+    // Release callback
+    void (*release)(struct ArrowArray*);
+    // Opaque producer-specific data
+    void* private_data;
+};
+
+#endif  // ARROW_C_DATA_INTERFACE
+
+/**
+ * TxnArrowBatch — Column buffers for up to `capacity` records. Reused from
+ * batch to batch unless it has been exported (exportTxnBatch shares it).
+ */
+class TxnArrowBatch {
+public:
+    explicit TxnArrowBatch(std::size_t capacity);
+
+    /** decode — Replace the contents with `count` raw Big-Endian records. */
+    void decode(const char* raw, std::size_t count);
+
+    std::size_t length() const   { return length_; }
+    std::size_t capacity() const { return txnId_.size(); }
+
+    const uint32_t* txnId() const       { return txnId_.data(); }
+    const uint32_t* amountCents() const { return amountCents_.data(); }
+    const uint16_t* storeNumber() const { return storeNumber_.data(); }
+    const uint16_t* pumpNumber() const  { return pumpNumber_.data(); }
+    const int32_t*  cardOffsets() const { return latin1_ ? utf8Offsets_.data() : cardOffsets_.data(); }
+    const char*     cardType() const    { return latin1_ ? utf8_.data() : cardType_.data(); }
+    std::size_t     cardBytes() const   { return static_cast<std::size_t>(cardOffsets()[length_]); }
+
+    /** cardRaw — 4 Latin-1 bytes per record, as on disk. */
+    const char*     cardRaw() const     { return cardType_.data(); }
+
+private:
+    std::size_t           length_ = 0;
+    std::vector<uint32_t> txnId_, amountCents_;
+    std::vector<uint16_t> storeNumber_, pumpNumber_;
+    std::vector<int32_t>  cardOffsets_;   // 0, 4, 8, … — fixed, filled once
+    std::vector<char>     cardType_;
+    bool                  latin1_ = false;   // some byte > 0x7F: utf8_ holds the values
+    std::vector<int32_t>  utf8Offsets_;      // sized on first use
+    std::vector<char>     utf8_;
+};
+
+/**
+ * ArrowIpcWriter — Arrow IPC stream of TxnArrowBatches on `out`. The schema
+ * message is written by the constructor, the end-of-stream marker by
+ * finish() (or the destructor).
+ */
+class ArrowIpcWriter {
+public:
+    explicit ArrowIpcWriter(std::ostream& out);
+    ~ArrowIpcWriter();
+
+    ArrowIpcWriter(const ArrowIpcWriter&) = delete;
+    ArrowIpcWriter& operator=(const ArrowIpcWriter&) = delete;
+
+    /** write — One record batch message; its body is the batch's buffers. */
+    void write(const TxnArrowBatch& batch);
+
+    /** finish — End-of-stream marker and flush; false if the stream failed. */
+    bool finish();
+
+    uint64_t bytesWritten() const { return bytes_; }
+
+private:
+    void writeMessage(const std::vector<uint8_t>& metadata);
+
+    std::ostream& out_;
+    uint64_t      bytes_    = 0;
+    bool          finished_ = false;
+};
+
+/**
+ * exportTxnSchema — The record batch schema (a struct of the five columns)
+ * through the C Data Interface. The consumer calls out->release.
+ */
+void exportTxnSchema(ArrowSchema* out);
+
+/**
+ * exportTxnBatch — `batch` as a C Data Interface struct array without
+ * copying: the array and each child keep `batch` alive until released, so
+ * the producer must not decode into it again (allocate a new batch).
+ */
+void exportTxnBatch(std::shared_ptr<const TxnArrowBatch> batch, ArrowArray* out);
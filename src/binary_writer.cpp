@@ -0,0 +1,94 @@
+// binary_writer.cpp — writev / vmsplice output of gathered batches
+
+#include "binary_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+/** advance — Drop the first `done` bytes of iov[0..count); returns the new first entry. */
+iovec* advance(iovec* iov, std::size_t& count, std::size_t done) {
+    while (count > 0 && done >= iov->iov_len) {
+        done -= iov->iov_len;
+        ++iov;
+        --count;
+    }
+    if (count > 0) {
+        iov->iov_base = static_cast<char*>(iov->iov_base) + done;
+        iov->iov_len -= done;
+    }
+    return iov;
+}
+
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+/**
+ * sizePipe — Shrink or grow the pipe on `fd` to the largest power-of-two
+ * capacity within `limit` that the kernel grants; the capacity, or 0.
+ */
+std::size_t sizePipe(int fd, std::size_t limit) {
+    const std::size_t page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    std::size_t want = page;
+    while (want * 2 <= std::min<std::size_t>(limit, std::size_t{1} << 20)) want *= 2;
+    for (; want >= page; want /= 2)
+        if (::fcntl(fd, F_SETPIPE_SZ, static_cast<int>(want)) >= 0) break;
+    const int capacity = ::fcntl(fd, F_GETPIPE_SZ);
+    return capacity > 0 ? static_cast<std::size_t>(capacity) : 0;
+}
+#endif
+
+}  // namespace
+
+BinaryWriter::BinaryWriter(int fd, std::size_t reuseLag) : fd_(fd) {
+    queued_.reserve(kMaxGather);
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        error_ = std::strerror(errno);
+        return;
+    }
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+    if (S_ISFIFO(st.st_mode)) {
+        const std::size_t capacity = sizePipe(fd, reuseLag);
+        if (capacity != 0 && capacity <= reuseLag) {
+            mode_ = Mode::kVmsplice;
+            pipeCapacity_ = capacity;
+        }
+    }
+#else
+    (void)reuseLag;
+#endif
+}
+
+bool BinaryWriter::gather(const void* data, std::size_t bytes) {
+    if (bytes == 0) return ok();
+    if (queued_.size() == kMaxGather && !flush()) return false;
+    queued_.push_back(iovec{const_cast<void*>(data), bytes});
+    return ok();
+}
+
+bool BinaryWriter::flush() {
+    iovec* iov = queued_.data();
+    std::size_t count = queued_.size();
+    while (count > 0 && ok()) {
+#if defined(__linux__) && defined(F_SETPIPE_SZ)
+        const ssize_t n = mode_ == Mode::kVmsplice ? ::vmsplice(fd_, iov, count, 0)
+                                                   : ::writev(fd_, iov, static_cast<int>(count));
+#else
+        const ssize_t n = ::writev(fd_, iov, static_cast<int>(count));
+#endif
+        ++syscalls_;
+        if (n < 0) {
+            if (errno != EINTR) error_ = std::strerror(errno);
+            continue;
+        }
+        bytes_ += static_cast<uint64_t>(n);
+        iov = advance(iov, count, static_cast<std::size_t>(n));
+    }
+    queued_.clear();
+    return ok();
+}
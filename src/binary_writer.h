@@ -0,0 +1,69 @@
+// binary_writer.h — Host-order TxnRecords as raw 16-byte records
+//
+// Other x86 services take the decoded export as it sits in memory: packed
+// little-endian TxnRecords, 16 bytes each, no header. Nothing has to be
+// formatted, so the cost is the write itself, and the writer keeps it to
+// one system call per many batches and no copy it can avoid:
+//
+//   writev    regular files, sockets, terminals: the queued batches go out
+//             in a single gather write (up to kMaxGather of them)
+//   vmsplice  pipes: the pages of the batches are handed to the pipe by
+//             reference, and the reader copies them out — the only copy
+//
+// gather() only queues a pointer; the memory must stay unchanged until
+// flush() has written it. With vmsplice it must stay unchanged longer,
+// until the reader has consumed it. The caller states how many bytes it
+// flushes after a buffer before writing that buffer again (`reuseLag`). The
+// pipe is resized to hold at most that much, so a buffer is out of the pipe
+// before it is reused. If the pipe cannot be sized that small, the writer
+// uses writev instead.
+//
+//   BinaryWriter out(fd, reuseLag);      // check out.ok()
+//   out.gather(batch, bytes);            // ... more batches
+//   out.flush();                         // false on a write error
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/uio.h>
+
+/** BinaryWriter — Gathered writes of caller-owned buffers to one descriptor (not owned). */
+class BinaryWriter {
+public:
+    enum class Mode : uint8_t { kWritev, kVmsplice };
+
+    /** Batches per system call; the Linux IOV_MAX. */
+    static constexpr std::size_t kMaxGather = 1024;
+
+    BinaryWriter(int fd, std::size_t reuseLag);
+
+    BinaryWriter(const BinaryWriter&) = delete;
+    BinaryWriter& operator=(const BinaryWriter&) = delete;
+
+    /** gather — Queue `bytes` at `data`; flushes first if kMaxGather are queued. */
+    bool gather(const void* data, std::size_t bytes);
+
+    /** flush — Write everything queued, retrying short writes; false on error. */
+    bool flush();
+
+    bool               ok() const           { return error_.empty(); }
+    const std::string& error() const        { return error_; }
+    Mode               mode() const         { return mode_; }
+    const char*        modeName() const     { return mode_ == Mode::kVmsplice ? "vmsplice" : "writev"; }
+    uint64_t           bytesWritten() const { return bytes_; }
+    uint64_t           syscalls() const     { return syscalls_; }
+    std::size_t        pipeCapacity() const { return pipeCapacity_; }   // 0 unless vmsplice
+
+private:
+    int                 fd_;
+    Mode                mode_         = Mode::kWritev;
+    std::size_t         pipeCapacity_ = 0;
+    std::vector<iovec>  queued_;
+    uint64_t            bytes_    = 0;
+    uint64_t            syscalls_ = 0;
+    std::string         error_;
+};
@@ -0,0 +1,154 @@
+// ebcdic.h — EBCDIC text and IBM decimal number fields
+//
+// The field formats of IBM i records other than binary integers:
+//
+//   EBCDIC text     code page 037 (US/Canada), translated byte-for-byte to
+//                   Latin-1 through a 256-entry table
+//   packed decimal  COMP-3: two BCD digits per byte, the sign in the low
+//                   nibble of the last byte (C/A/E/F positive, D/B negative)
+//   zoned decimal   one EBCDIC digit (0xF0–0xF9) per byte; the zone nibble
+//                   of the last byte carries the sign (C/F positive, D/B
+//                   negative)
+//
+// The decimal decoders return the unscaled integer (implied decimal places
+// belong to the record layout) and false on a nibble that is neither digit
+// nor sign, so corrupt fields are rejected rather than misread. Whole
+// columns of zoned fields go through decodeZonedBatch (SIMD, libpos).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+/** kEbcdic037ToLatin1 — CP037 → ISO-8859-1 (a bijection). */
+inline constexpr unsigned char kEbcdic037ToLatin1[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x9C, 0x09, 0x86, 0x7F, 0x97, 0x8D, 0x8E, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x9D, 0x85, 0x08, 0x87, 0x18, 0x19, 0x92, 0x8F, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x80, 0x81, 0x82, 0x83, 0x84, 0x0A, 0x17, 0x1B, 0x88, 0x89, 0x8A, 0x8B, 0x8C, 0x05, 0x06, 0x07,
+    0x90, 0x91, 0x16, 0x93, 0x94, 0x95, 0x96, 0x04, 0x98, 0x99, 0x9A, 0x9B, 0x14, 0x15, 0x9E, 0x1A,
+    0x20, 0xA0, 0xE2, 0xE4, 0xE0, 0xE1, 0xE3, 0xE5, 0xE7, 0xF1, 0xA2, 0x2E, 0x3C, 0x28, 0x2B, 0x7C,
+    0x26, 0xE9, 0xEA, 0xEB, 0xE8, 0xED, 0xEE, 0xEF, 0xEC, 0xDF, 0x21, 0x24, 0x2A, 0x29, 0x3B, 0xAC,
+    0x2D, 0x2F, 0xC2, 0xC4, 0xC0, 0xC1, 0xC3, 0xC5, 0xC7, 0xD1, 0xA6, 0x2C, 0x25, 0x5F, 0x3E, 0x3F,
+    0xF8, 0xC9, 0xCA, 0xCB, 0xC8, 0xCD, 0xCE, 0xCF, 0xCC, 0x60, 0x3A, 0x23, 0x40, 0x27, 0x3D, 0x22,
+    0xD8, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0xAB, 0xBB, 0xF0, 0xFD, 0xFE, 0xB1,
+    0xB0, 0x6A, 0x6B, 0x6C, 0x6D, 0x6E, 0x6F, 0x70, 0x71, 0x72, 0xAA, 0xBA, 0xE6, 0xB8, 0xC6, 0xA4,
+    0xB5, 0x7E, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7A, 0xA1, 0xBF, 0xD0, 0xDD, 0xDE, 0xAE,
+    0x5E, 0xA3, 0xA5, 0xB7, 0xA9, 0xA7, 0xB6, 0xBC, 0xBD, 0xBE, 0x5B, 0x5D, 0xAF, 0xA8, 0xB4, 0xD7,
+    0x7B, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0xAD, 0xF4, 0xF6, 0xF2, 0xF3, 0xF5,
+    0x7D, 0x4A, 0x4B, 0x4C, 0x4D, 0x4E, 0x4F, 0x50, 0x51, 0x52, 0xB9, 0xFB, 0xFC, 0xF9, 0xFA, 0xFF,
+    0x5C, 0xF7, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5A, 0xB2, 0xD4, 0xD6, 0xD2, 0xD3, 0xD5,
+    0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0xB3, 0xDB, 0xDC, 0xD9, 0xDA, 0x9F,
+};
+
+/** kLatin1ToEbcdic037 — Inverse of kEbcdic037ToLatin1. */
+inline constexpr unsigned char kLatin1ToEbcdic037[256] = {
+    0x00, 0x01, 0x02, 0x03, 0x37, 0x2D, 0x2E, 0x2F, 0x16, 0x05, 0x25, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F,
+    0x10, 0x11, 0x12, 0x13, 0x3C, 0x3D, 0x32, 0x26, 0x18, 0x19, 0x3F, 0x27, 0x1C, 0x1D, 0x1E, 0x1F,
+    0x40, 0x5A, 0x7F, 0x7B, 0x5B, 0x6C, 0x50, 0x7D, 0x4D, 0x5D, 0x5C, 0x4E, 0x6B, 0x60, 0x4B, 0x61,
+    0xF0, 0xF1, 0xF2, 0xF3, 0xF4, 0xF5, 0xF6, 0xF7, 0xF8, 0xF9, 0x7A, 0x5E, 0x4C, 0x7E, 0x6E, 0x6F,
+    0x7C, 0xC1, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, 0xC8, 0xC9, 0xD1, 0xD2, 0xD3, 0xD4, 0xD5, 0xD6,
+    0xD7, 0xD8, 0xD9, 0xE2, 0xE3, 0xE4, 0xE5, 0xE6, 0xE7, 0xE8, 0xE9, 0xBA, 0xE0, 0xBB, 0xB0, 0x6D,
+    0x79, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96,
+    0x97, 0x98, 0x99, 0xA2, 0xA3, 0xA4, 0xA5, 0xA6, 0xA7, 0xA8, 0xA9, 0xC0, 0x4F, 0xD0, 0xA1, 0x07,
+    0x20, 0x21, 0x22, 0x23, 0x24, 0x15, 0x06, 0x17, 0x28, 0x29, 0x2A, 0x2B, 0x2C, 0x09, 0x0A, 0x1B,
+    0x30, 0x31, 0x1A, 0x33, 0x34, 0x35, 0x36, 0x08, 0x38, 0x39, 0x3A, 0x3B, 0x04, 0x14, 0x3E, 0xFF,
+    0x41, 0xAA, 0x4A, 0xB1, 0x9F, 0xB2, 0x6A, 0xB5, 0xBD, 0xB4, 0x9A, 0x8A, 0x5F, 0xCA, 0xAF, 0xBC,
+    0x90, 0x8F, 0xEA, 0xFA, 0xBE, 0xA0, 0xB6, 0xB3, 0x9D, 0xDA, 0x9B, 0x8B, 0xB7, 0xB8, 0xB9, 0xAB,
+    0x64, 0x65, 0x62, 0x66, 0x63, 0x67, 0x9E, 0x68, 0x74, 0x71, 0x72, 0x73, 0x78, 0x75, 0x76, 0x77,
+    0xAC, 0x69, 0xED, 0xEE, 0xEB, 0xEF, 0xEC, 0xBF, 0x80, 0xFD, 0xFE, 0xFB, 0xFC, 0xAD, 0xAE, 0x59,
+    0x44, 0x45, 0x42, 0x46, 0x43, 0x47, 0x9C, 0x48, 0x54, 0x51, 0x52, 0x53, 0x58, 0x55, 0x56, 0x57,
+    0x8C, 0x49, 0xCD, 0xCE, 0xCB, 0xCF, 0xCC, 0xE1, 0x70, 0xDD, 0xDE, 0xDB, 0xDC, 0x8D, 0x8E, 0xDF,
+};
+
+/** ebcdicToLatin1 — Translate `len` bytes; `out` may equal `in`. */
+inline void ebcdicToLatin1(const char* in, std::size_t len, char* out) {
+    for (std::size_t i = 0; i < len; ++i)
+        out[i] = static_cast<char>(kEbcdic037ToLatin1[static_cast<unsigned char>(in[i])]);
+}
+
+/** latin1ToEbcdic — Inverse of ebcdicToLatin1 (test data). */
+inline void latin1ToEbcdic(const char* in, std::size_t len, char* out) {
+    for (std::size_t i = 0; i < len; ++i)
+        out[i] = static_cast<char>(kLatin1ToEbcdic037[static_cast<unsigned char>(in[i])]);
+}
+
+/**
+ * latin1ToUtf8 — Encode `len` Latin-1 bytes as UTF-8 into `out` (room for
+ * 2·len); returns the bytes written. Bytewise order is preserved.
+ */
+inline std::size_t latin1ToUtf8(const char* in, std::size_t len, char* out) {
+    std::size_t o = 0;
+    for (std::size_t i = 0; i < len; ++i) {
+        const unsigned b = static_cast<unsigned char>(in[i]);
+        if (b < 0x80) {
+            out[o++] = static_cast<char>(b);
+        } else {
+            out[o++] = static_cast<char>(0xC0 | b >> 6);
+            out[o++] = static_cast<char>(0x80 | (b & 0x3F));
+        }
+    }
+    return o;
+}
+
+/**
+ * decodePacked — COMP-3 field of `width` bytes: 2·width−1 digits, so widths
+ * up to 9 (17 digits) fit int64 without overflow checks.
+ */
+inline bool decodePacked(const char* p, std::size_t width, int64_t& out) {
+    int64_t  v   = 0;
+    unsigned bad = 0;
+    for (std::size_t i = 0; i + 1 < width; ++i) {
+        const unsigned b = static_cast<unsigned char>(p[i]);
+        bad |= ((b >> 4) > 9) | ((b & 0xF) > 9);
+        v = v * 100 + (b >> 4) * 10 + (b & 0xF);
+    }
+    const unsigned last = static_cast<unsigned char>(p[width - 1]);
+    const unsigned sign = last & 0xF;
+    bad |= ((last >> 4) > 9) | (sign < 0xA);
+    v = v * 10 + (last >> 4);
+    out = (sign == 0xD || sign == 0xB) ? -v : v;
+    return !bad;
+}
+
+/** encodePacked — Inverse of decodePacked (sign nibble C or D). */
+inline void encodePacked(int64_t value, std::size_t width, char* p) {
+    uint64_t v = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    p[width - 1] = static_cast<char>((v % 10) << 4 | (value < 0 ? 0xD : 0xC));
+    v /= 10;
+    for (std::size_t i = width - 1; i-- > 0; v /= 100)
+        p[i] = static_cast<char>((v / 10 % 10) << 4 | v % 10);
+}
+
+/** decodeZoned — Zoned-decimal field of `width` bytes (up to 18 digits). */
+inline bool decodeZoned(const char* p, std::size_t width, int64_t& out) {
+    int64_t  v   = 0;
+    unsigned bad = 0;
+    for (std::size_t i = 0; i + 1 < width; ++i) {
+        const unsigned b = static_cast<unsigned char>(p[i]);
+        bad |= ((b >> 4) != 0xF) | ((b & 0xF) > 9);
+        v = v * 10 + (b & 0xF);
+    }
+    const unsigned last = static_cast<unsigned char>(p[width - 1]);
+    const unsigned zone = last >> 4;
+    bad |= ((last & 0xF) > 9) | (zone < 0xA);
+    v = v * 10 + (last & 0xF);
+    out = (zone == 0xD || zone == 0xB) ? -v : v;
+    return !bad;
+}
+
+/**
+ * decodeZonedBatch — decodeZoned of the `width`-byte field at in + i·inStride
+ * for each i < count, stored as int64 at out + i·outStride (0 when invalid).
+ * Returns the number of invalid fields. Vectorized on x86-64-v2 and later
+ * for widths up to 16 (zoned_decimal.cpp).
+ */
+std::size_t decodeZonedBatch(const char* in, std::size_t inStride, std::size_t width,
+                             std::size_t count, char* out, std::size_t outStride);
+
+/** encodeZoned — Inverse of decodeZoned (last zone C or D). */
+inline void encodeZoned(int64_t value, std::size_t width, char* p) {
+    uint64_t v = value < 0 ? 0 - static_cast<uint64_t>(value) : static_cast<uint64_t>(value);
+    for (std::size_t i = width; i-- > 0; v /= 10)
+        p[i] = static_cast<char>(0xF0 | v % 10);
+    p[width - 1] = static_cast<char>((p[width - 1] & 0x0F) | (value < 0 ? 0xD0 : 0xC0));
+}
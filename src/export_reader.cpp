@@ -0,0 +1,151 @@
+// export_reader.cpp — Buffered, mmap and O_DIRECT export scans with eviction
+
+#include "export_reader.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char* readModeName(ReadMode mode) {
+    return mode == ReadMode::kMmap ? "mmap" : mode == ReadMode::kDirect ? "direct" : "buffered";
+}
+
+ExportReader::ExportReader(const std::string& path, ReadMode mode, bool evict, std::size_t recordLength)
+    : mode_(mode), evict_(evict), recordLength_(std::max<std::size_t>(recordLength, 1)),
+      carryRoom_((recordLength_ + kAlign - 1) / kAlign * kAlign) {
+    fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC | (mode_ == ReadMode::kDirect ? O_DIRECT : 0));
+    if (fd_ < 0 && mode_ == ReadMode::kDirect && errno == EINVAL) {
+        note_  = "O_DIRECT not supported for " + path + "; reading buffered with eviction";
+        mode_  = ReadMode::kBuffered;
+        evict_ = true;
+        fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    }
+    if (fd_ < 0) {
+        error_ = "cannot read " + path + ": " + std::strerror(errno);
+        return;
+    }
+    struct stat st{};
+    if (::fstat(fd_, &st) != 0) {
+        error_ = "cannot stat " + path + ": " + std::strerror(errno);
+        return;
+    }
+    size_ = static_cast<uint64_t>(st.st_size);
+    if (size_ % recordLength_ != 0) {
+        error_ = path + " is not a whole number of " + std::to_string(recordLength_) + "-byte records";
+        return;
+    }
+    if (mode_ != ReadMode::kDirect) ::posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    if (mode_ == ReadMode::kMmap) {
+        if (size_ == 0) return;
+        void* p = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd_, 0);
+        if (p == MAP_FAILED) {
+            error_ = "cannot map " + path + ": " + std::strerror(errno);
+            return;
+        }
+        map_ = static_cast<const char*>(p);
+        ::madvise(p, size_, MADV_SEQUENTIAL);
+        return;
+    }
+    buffer_ = PageBuffer(carryRoom_ + kChunkBytes);
+    if (!buffer_.data()) error_ = "cannot allocate the read buffer";
+}
+
+ExportReader::~ExportReader() {
+    if (map_) ::munmap(const_cast<char*>(map_), size_);
+    if (fd_ >= 0) ::close(fd_);
+}
+
+std::size_t ExportReader::next(std::size_t maxRecords, const char*& raw) {
+    if (!ok()) return 0;
+    if (mode_ == ReadMode::kMmap) {
+        evictBehind(cursor_);   // the previous batch is done with
+        const std::size_t n = std::min<uint64_t>(maxRecords, (size_ - cursor_) / recordLength_);
+        if (n == 0) {
+            evictBehind(size_);
+            return 0;
+        }
+        raw = map_ + cursor_;
+        cursor_ += n * recordLength_;
+        return n;
+    }
+    if (chunkStart_ + chunkBytes_ - cursor_ < recordLength_ && !refill()) return 0;
+    const std::size_t n = std::min<uint64_t>(maxRecords,
+                                             (chunkStart_ + chunkBytes_ - cursor_) / recordLength_);
+    // cursor_ is behind chunkStart_ by the carried bytes of a split record
+    raw = buffer_.data() + static_cast<std::size_t>(carryRoom_ + cursor_ - chunkStart_);
+    cursor_ += n * recordLength_;
+    return n;
+}
+
+/** refill — Give back the consumed chunk and read the next one; false at the end or on error. */
+bool ExportReader::refill() {
+    // The start of a record split by the chunk boundary goes just in front of the next chunk
+    const std::size_t carry = static_cast<std::size_t>(chunkStart_ + chunkBytes_ - cursor_);
+    std::memmove(buffer_.data() + carryRoom_ - carry, buffer_.data() + carryRoom_ + chunkBytes_ - carry, carry);
+    evictBehind(chunkStart_ + chunkBytes_);
+    chunkStart_ += chunkBytes_;
+    chunkBytes_ = 0;
+    if (chunkStart_ >= size_) return false;
+
+    const std::size_t want = static_cast<std::size_t>(std::min<uint64_t>(kChunkBytes, size_ - chunkStart_));
+    // O_DIRECT transfers whole blocks; the short read at end of file is the remainder
+    const std::size_t request = mode_ == ReadMode::kDirect ? (want + kAlign - 1) / kAlign * kAlign : want;
+    std::size_t got = 0;
+    while (got < want) {
+        const ssize_t n = ::pread(fd_, buffer_.data() + carryRoom_ + got, request - got,
+                                  static_cast<off_t>(chunkStart_ + got));
+        if (n > 0) {
+            got += static_cast<std::size_t>(n);
+        } else if (n == 0 || errno != EINTR) {
+            error_ = std::string("read failed: ") + (n == 0 ? "file shrank during the scan" : std::strerror(errno));
+            return false;
+        }
+    }
+    chunkBytes_ = want;
+    return true;
+}
+
+/**
+ * evictBehind — Give the pages of whole kChunkBytes windows before `upTo`
+ * (or everything, at the end of the file) back to the kernel.
+ */
+void ExportReader::evictBehind(uint64_t upTo) {
+    if (!evict_ || mode_ == ReadMode::kDirect) return;
+    const uint64_t end = upTo >= size_ ? size_ : upTo / kChunkBytes * kChunkBytes;
+    if (end <= evicted_) return;
+    if (map_) ::madvise(const_cast<char*>(map_) + evicted_, end - evicted_, MADV_DONTNEED);
+    ::posix_fadvise(fd_, static_cast<off_t>(evicted_), static_cast<off_t>(end - evicted_), POSIX_FADV_DONTNEED);
+    evicted_ = end;
+}
+
+int64_t residentBytes(const std::string& path) {
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    struct stat st{};
+    int64_t resident = -1;
+    if (::fstat(fd, &st) == 0 && st.st_size == 0) {
+        resident = 0;
+    } else if (st.st_size > 0) {
+        const auto size = static_cast<std::size_t>(st.st_size);
+        void* p = ::mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+        if (p != MAP_FAILED) {
+            const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+            std::vector<unsigned char> pages((size + page - 1) / page);
+            if (::mincore(p, size, pages.data()) == 0) {
+                std::size_t count = 0;
+                for (unsigned char v : pages) count += v & 1;
+                resident = static_cast<int64_t>(std::min(count * page, size));
+            }
+            ::munmap(p, size);
+        }
+    }
+    ::close(fd);
+    return resident;
+}
@@ -0,0 +1,93 @@
+// export_reader.h — Batches of raw Big-Endian records read from an export file
+//
+// A nightly export is scanned once, front to back. Read the ordinary way,
+// a 40 GB scan fills the page cache with pages nobody will read again and
+// pushes out the working set of every other service on the host.
+// ExportReader has three ways to read, and in the two that go through
+// the page cache it gives pages back as soon as the cursor has passed them:
+//
+//   kBuffered  read() into one aligned chunk buffer, then
+//              posix_fadvise(DONTNEED) on each chunk once it is consumed
+//   kMmap      the file mapped read-only and batches handed out in place,
+//              no copy. Each window behind the cursor is dropped from the
+//              mapping with madvise(DONTNEED) and then from the page cache
+//              with posix_fadvise(DONTNEED)
+//   kDirect    O_DIRECT reads of whole aligned blocks into an aligned
+//              buffer; the page cache is never involved
+//
+// The file must hold whole records: 16-byte TxnRecords unless another
+// record length is given (a runtime layout's, record_schema.h). A record
+// split across two chunks is moved in front of the next chunk, so batches
+// are always contiguous. Filesystems that refuse O_DIRECT (EINVAL, e.g.
+// older tmpfs) fall back to kBuffered with eviction; mode() and note() say so.
+//
+//   ExportReader in(path, ReadMode::kDirect, /*evict=*/true);   // check ok()
+//   const char* raw;
+//   while (std::size_t n = in.next(batch, raw)) worker.process(raw, n, t);
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "numa_topology.h"
+#include "txn_record.h"
+
+enum class ReadMode : uint8_t { kBuffered, kMmap, kDirect };
+
+/** readModeName — "buffered", "mmap" or "direct". */
+const char* readModeName(ReadMode mode);
+
+/** ExportReader — One forward scan of an export file. Not thread-safe. */
+class ExportReader {
+public:
+    static constexpr std::size_t kAlign      = 4096;
+    static constexpr std::size_t kChunkBytes = std::size_t{4} << 20;   // read / eviction granule
+
+    ExportReader(const std::string& path, ReadMode mode, bool evict,
+                 std::size_t recordLength = sizeof(TxnRecord));
+    ~ExportReader();
+
+    ExportReader(const ExportReader&) = delete;
+    ExportReader& operator=(const ExportReader&) = delete;
+
+    /**
+     * next — Up to `maxRecords` whole records at `raw`; 0 at the end (or on
+     * a read error, see ok()). `raw` stays valid until the next call.
+     */
+    std::size_t next(std::size_t maxRecords, const char*& raw);
+
+    bool               ok() const           { return error_.empty(); }
+    const std::string& error() const        { return error_; }
+    const std::string& note() const         { return note_; }   // e.g. the O_DIRECT fallback
+    ReadMode           mode() const         { return mode_; }
+    uint64_t           fileBytes() const    { return size_; }
+    uint64_t           bytesRead() const    { return cursor_; }
+    uint64_t           evictedBytes() const { return evicted_; }   // given back behind the cursor
+
+private:
+    bool refill();
+    void evictBehind(uint64_t upTo);
+
+    ReadMode    mode_;
+    bool        evict_;
+    std::size_t recordLength_;
+    std::size_t carryRoom_;         // kAlign multiple in front of each chunk for a split record
+    int         fd_   = -1;
+    uint64_t    size_ = 0;
+    const char* map_  = nullptr;    // kMmap
+    PageBuffer  buffer_;            // kBuffered / kDirect
+    uint64_t    chunkStart_ = 0;    // file offset of buffer_[carryRoom_]
+    std::size_t chunkBytes_ = 0;    // valid bytes in buffer_
+    uint64_t    cursor_     = 0;    // file offset of the next record
+    uint64_t    evicted_    = 0;    // file offset up to which pages were given back
+    std::string error_;
+    std::string note_;
+};
+
+/**
+ * residentBytes — How much of the file at `path` is in the page cache
+ * right now (mincore over a temporary mapping); -1 if it cannot tell.
+ */
+int64_t residentBytes(const std::string& path);
@@ -0,0 +1,49 @@
+// ingest_protocol.h — Wire format of the pos_modern TCP ingest mode
+//
+// Store controllers (and pos_loadtest) stream records to `pos_modern
+// --listen PORT` as framed messages over one TCP connection:
+//
+//   client → server   uint32 count (Big-Endian), then count × 16-byte
+//                     TxnRecords in the unchanged OS/400 layout
+//   server → client   uint32 accepted (Big-Endian), sent once the message has
+//                     been decoded, validated and sunk
+//
+// Acks are returned in message order, so a client can match them to its
+// send queue without sequence numbers.
+
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+
+#include <sys/socket.h>
+
+/** Upper bound on records per message; larger counts close the connection. */
+inline constexpr uint32_t kIngestMaxRecords = 1u << 16;
+
+/** recvFull — Read exactly `len` bytes; false on EOF or error. */
+inline bool recvFull(int fd, void* buf, std::size_t len) {
+    auto* p = static_cast<char*>(buf);
+    while (len > 0) {
+        const ssize_t n = ::recv(fd, p, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
+
+/** sendFull — Write exactly `len` bytes; false on error. */
+inline bool sendFull(int fd, const void* buf, std::size_t len) {
+    const auto* p = static_cast<const char*>(buf);
+    while (len > 0) {
+        const ssize_t n = ::send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        p += n;
+        len -= static_cast<std::size_t>(n);
+    }
+    return true;
+}
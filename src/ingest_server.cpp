@@ -0,0 +1,307 @@
+// ingest_server.cpp — TCP ingest mode (`pos_modern --listen PORT`)
+//
+// Framing is defined in ingest_protocol.h. Two servers share it:
+//
+//   io_uring (default)  opts.threads executor threads, each with its own
+//                       SO_REUSEPORT listener, ring and PipelineWorker; every
+//                       connection is a coroutine (uring_executor.h), so
+//                       100k idle store controllers cost kilobytes each
+//   thread-per-conn     fallback when io_uring is unavailable (old kernel,
+//                       seccomp, io_uring_disabled), one PipelineWorker each
+
+#include "pipeline.h"
+
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <list>
+#include <thread>
+
+#include <netinet/tcp.h>
+#include <sys/resource.h>
+
+#include "ingest_protocol.h"
+#include "uring_executor.h"
+
+namespace {
+
+/**
+ * waitReadable — Block until `fd` is readable or a stop is requested, polling
+ * in short slices so SIGINT/SIGTERM shut the daemon down promptly.
+ */
+bool waitReadable(int fd) {
+    while (!g_stopRequested.load(std::memory_order_relaxed)) {
+        pollfd pfd{fd, POLLIN, 0};
+        const int r = ::poll(&pfd, 1, 200);
+        if (r > 0) return true;
+        if (r < 0 && errno != EINTR) return false;
+    }
+    return false;
+}
+
+/**
+ * serveConnection — Decode every framed message on `conn` and ack it with
+ * the number of records accepted.
+ */
+void serveConnection(Pipeline& pipeline, int conn) {
+    PipelineWorker worker(pipeline);
+    std::vector<char> raw;
+
+    while (waitReadable(conn)) {
+        uint32_t countBe;
+        if (!recvFull(conn, &countBe, sizeof(countBe))) break;
+        const uint32_t count = fromBigEndian32(countBe);
+        if (count > kIngestMaxRecords) break;
+
+        const uint64_t tRead = pipeline.clock.now();
+        raw.resize(std::size_t{count} * sizeof(TxnRecord));
+        if (!recvFull(conn, raw.data(), raw.size())) break;
+
+        uint32_t accepted = 0;
+        for (std::size_t off = 0; off < count; off += pipeline.opts.batch) {
+            const std::size_t n = std::min<std::size_t>(pipeline.opts.batch, count - off);
+            accepted += static_cast<uint32_t>(
+                worker.process(raw.data() + off * sizeof(TxnRecord), n, tRead));
+        }
+        const uint32_t ackBe = fromBigEndian32(accepted);
+        if (!sendFull(conn, &ackBe, sizeof(ackBe))) break;
+    }
+
+    ::close(conn);
+    pipeline.mergeTotals(worker.totals);
+    worker.reportPerf(std::cerr);
+}
+
+/**
+ * listenOn — Bound, listening TCP socket on INADDR_ANY:port, or -1. With
+ * `reusePort` several sockets share the port and the kernel spreads
+ * incoming connections over them.
+ */
+int listenOn(std::size_t port, bool reusePort) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    const int one = 1;
+    ::setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+    if (reusePort) ::setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one));
+    sockaddr_in addr{};
+    addr.sin_family      = AF_INET;
+    addr.sin_port        = htons(static_cast<uint16_t>(port));
+    addr.sin_addr.s_addr = htonl(INADDR_ANY);
+    if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+        || ::listen(fd, SOMAXCONN) != 0) {
+        ::close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+/** raiseFdLimit — Lift the soft RLIMIT_NOFILE to the hard limit for many connections. */
+void raiseFdLimit() {
+    rlimit lim{};
+    if (::getrlimit(RLIMIT_NOFILE, &lim) == 0 && lim.rlim_cur < lim.rlim_max) {
+        lim.rlim_cur = lim.rlim_max;
+        ::setrlimit(RLIMIT_NOFILE, &lim);
+    }
+}
+
+#if defined(POS_HAVE_IO_URING)
+
+/**
+ * ConnectionFd — Closes a connection socket with the task that owns it,
+ * whether the task returns or its frame is destroyed at shutdown.
+ */
+struct ConnectionFd {
+    int fd;
+    ~ConnectionFd() { ::close(fd); }
+};
+
+/**
+ * ingestConnection — One store controller: await a header, then the body
+ * one batch at a time (so the receive buffer never exceeds a batch and is
+ * released between messages), process it, and ack. Yields between batches
+ * so one large message cannot starve the other connections on this ring.
+ */
+UringTask ingestConnection(UringExecutor& ex, PipelineWorker& worker, Pipeline& pipeline,
+                           int conn) {
+    const ConnectionFd guard{conn};
+    const std::size_t batch = pipeline.opts.batch;
+    uint32_t countBe = 0;
+
+    while (co_await ex.recvExactly(conn, &countBe, sizeof(countBe))) {
+        const uint32_t count = fromBigEndian32(countBe);
+        if (count > kIngestMaxRecords) break;
+
+        const uint64_t tRead = pipeline.clock.now();
+        std::vector<char> raw(std::min<std::size_t>(count, batch) * sizeof(TxnRecord));
+        uint32_t accepted = 0;
+        bool ok = true;
+        for (std::size_t off = 0; off < count && ok; off += batch) {
+            const std::size_t n = std::min<std::size_t>(batch, count - off);
+            ok = co_await ex.recvExactly(conn, raw.data(), n * sizeof(TxnRecord));
+            if (!ok) break;
+            accepted += static_cast<uint32_t>(worker.process(raw.data(), n, tRead));
+            if (off + n < count) co_await ex.yield();
+        }
+        if (!ok) break;
+
+        const uint32_t ackBe = fromBigEndian32(accepted);
+        if (!co_await ex.sendExactly(conn, &ackBe, sizeof(ackBe))) break;
+    }
+}
+
+/**
+ * acceptConnections — Spawn an ingestConnection task per accepted socket.
+ * When accept fails (EMFILE, ENFILE, ENOBUFS, ...) it waits a few
+ * milliseconds on the ring before retrying, so the connections that hold
+ * the descriptors can finish instead of the loop spinning on the error.
+ */
+UringTask acceptConnections(UringExecutor& ex, PipelineWorker& worker, Pipeline& pipeline,
+                            int listenFd) {
+    constexpr int kBackoffMs = 5;
+    const int one = 1;
+    for (;;) {
+        const int conn = co_await ex.accept(listenFd);
+        if (conn == -ECANCELED) break;
+        if (conn < 0) {
+            co_await ex.sleep(kBackoffMs);
+            continue;
+        }
+        ::setsockopt(conn, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        ex.spawn(ingestConnection(ex, worker, pipeline, conn));
+    }
+}
+
+/**
+ * serveUring — One executor thread's share of the ingest port. Returns
+ * false if this thread could not create its ring or listener.
+ */
+bool serveUring(Pipeline& pipeline, std::size_t index, std::size_t& peakConnections) {
+    UringExecutor ex;
+    if (!ex.ok()) return false;
+    const int fd = listenOn(pipeline.opts.listenPort, true);
+    if (fd < 0) return false;
+
+    {
+        PipelineWorker worker(pipeline);
+        ex.spawn(acceptConnections(ex, worker, pipeline, fd));
+        ex.run([] { return g_stopRequested.load(std::memory_order_relaxed); },
+               [&] {
+                   if (index == 0 && g_dumpRequested.exchange(false, std::memory_order_relaxed))
+                       pipeline.latency.dump(std::cerr);
+               });
+        // the accept task is still suspended; it does not count as a connection
+        peakConnections = ex.peakTasks() - 1;
+        pipeline.mergeTotals(worker.totals);
+        worker.reportPerf(std::cerr);
+    }
+    ::close(fd);
+    return true;
+}
+
+/**
+ * runUringIngest — opts.threads executor threads until stopped. Returns the
+ * exit status, or -1 (nothing started) if io_uring cannot be used here.
+ */
+int runUringIngest(Pipeline& pipeline) {
+    {
+        UringExecutor probe(8, 16);
+        if (!probe.ok()) {
+            std::cerr << "io_uring unavailable (" << std::strerror(probe.error())
+                      << "); using one thread per connection\n";
+            return -1;
+        }
+    }
+    const std::size_t threads = std::max<std::size_t>(1, pipeline.opts.threads);
+    std::vector<std::size_t> peaks(threads, 0);
+    std::vector<std::thread> executors;
+    std::atomic<bool> failed{false};
+    for (std::size_t i = 0; i < threads; ++i)
+        executors.emplace_back([&, i] {
+            if (!serveUring(pipeline, i, peaks[i])) {
+                failed.store(true);
+                requestStop();
+            }
+        });
+    std::cerr << "ingest listening on port " << pipeline.opts.listenPort << " (io_uring, "
+              << threads << " executor thread" << (threads == 1 ? "" : "s") << ")\n";
+    for (auto& t : executors) t.join();
+    if (failed.load()) {
+        std::cerr << "cannot listen on port " << pipeline.opts.listenPort << "\n";
+        return 1;
+    }
+
+    std::size_t peak = 0;
+    for (std::size_t p : peaks) peak += p;
+    pipeline.printSummary("Modernized x86 TCP Ingest");
+    std::cout << "Peak conns : " << peak << "\n";
+    pipeline.latency.dump(std::cerr);
+    return 0;
+}
+
+#endif  // POS_HAVE_IO_URING
+
+}  // namespace
+
+int runIngest(const StreamOptions& opts) {
+    Pipeline pipeline(opts);
+    if (!pipeline.startMetricsServer())
+        return 1;
+    installSignalHandlers();
+    raiseFdLimit();
+
+#if defined(POS_HAVE_IO_URING)
+    if (const int status = runUringIngest(pipeline); status >= 0)
+        return status;
+#endif
+
+    const int fd = listenOn(opts.listenPort, false);
+    if (fd < 0) {
+        std::cerr << "cannot listen on port " << opts.listenPort << "\n";
+        return 1;
+    }
+    std::cerr << "ingest listening on port " << opts.listenPort << "\n";
+
+    // Finished connection threads are joined every poll slice, so a
+    // long-running daemon holds only the threads of its open connections
+    struct Connection {
+        std::thread       thread;
+        std::atomic<bool> done{false};
+    };
+    std::list<Connection> connections;
+    auto reap = [&] {
+        for (auto it = connections.begin(); it != connections.end();) {
+            if (it->done.load(std::memory_order_acquire)) {
+                it->thread.join();
+                it = connections.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    };
+
+    const int one = 1;
+    while (!g_stopRequested.load(std::memory_order_relaxed)) {
+        pollfd pfd{fd, POLLIN, 0};
+        const int r = ::poll(&pfd, 1, 200);
+        reap();
+        if (g_dumpRequested.exchange(false, std::memory_order_relaxed))
+            pipeline.latency.dump(std::cerr);
+        if (r < 0 && errno != EINTR) break;
+        if (r <= 0) continue;
+
+        const int conn = ::accept4(fd, nullptr, nullptr, SOCK_CLOEXEC);
+        if (conn < 0) continue;
+        ::setsockopt(conn, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+        Connection& c = connections.emplace_back();
+        c.thread = std::thread([&pipeline, &c, conn] {
+            serveConnection(pipeline, conn);
+            c.done.store(true, std::memory_order_release);
+        });
+    }
+    ::close(fd);
+    for (Connection& c : connections) c.thread.join();
+
+    pipeline.printSummary("Modernized x86 TCP Ingest");
+    pipeline.latency.dump(std::cerr);
+    return 0;
+}
@@ -0,0 +1,169 @@
+// metrics.h — Per-thread pipeline counters rendered in Prometheus text format
+//
+// Counters follow the same threading model as latency_histogram.h:
+//   - Each worker thread attaches once and owns a cache-line-aligned block of
+//     counters, so hot-path increments never share a line with another
+//     thread (no false sharing) and never take a lock.
+//   - Nothing is aggregated until a scrape asks for it; the scraping thread
+//     sums every block and renders the Prometheus exposition format.
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "latency_histogram.h"
+
+/**
+ * CounterBlock — One thread's counters, padded to whole cache lines.
+ */
+struct alignas(64) CounterBlock {
+    static constexpr std::size_t kMaxCounters = 16;
+
+    /** add — Single-writer increment; only the owning thread may call this. */
+    void add(std::size_t idx, uint64_t n) noexcept {
+        auto& c = values[idx];
+        c.store(c.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+    }
+
+    std::atomic<uint64_t> values[kMaxCounters] = {};
+};
+
+struct MetricDesc {
+    std::string name;   // e.g. "pos_records_total"
+    std::string help;   // one-line HELP text
+};
+
+/**
+ * MetricsRegistry — Counter definitions, per-thread blocks, and the scrape-time
+ * aggregation/rendering. Counter index i in every CounterBlock corresponds
+ * to counters()[i].
+ */
+class MetricsRegistry {
+public:
+    explicit MetricsRegistry(std::vector<MetricDesc> counters)
+        : counters_(std::move(counters)),
+          lastTotals_(counters_.size(), 0),
+          lastScrape_(std::chrono::steady_clock::now()) {}
+
+    /** attachThread — Allocate the calling thread's counter block. */
+    CounterBlock* attachThread() {
+        auto block = std::make_unique<CounterBlock>();
+        CounterBlock* raw = block.get();
+        std::lock_guard<std::mutex> lock(mutex_);
+        blocks_.push_back(std::move(block));
+        return raw;
+    }
+
+    /** total — Current sum of counter `idx` across all threads. */
+    uint64_t total(std::size_t idx) const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t sum = 0;
+        for (const auto& block : blocks_)
+            sum += block->values[idx].load(std::memory_order_relaxed);
+        return sum;
+    }
+
+    /** setInfo — Constant label exported as `<name>{<label>="<value>"} 1`. */
+    void setInfo(std::string name, std::string label, std::string value) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        info_.push_back({std::move(name), std::move(label), std::move(value)});
+    }
+
+    /** addLatency — Export every stage of `reg` as a Prometheus histogram. */
+    void addLatency(std::string name, const LatencyRegistry* reg) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        latency_.emplace_back(std::move(name), reg);
+    }
+
+    /**
+     * renderPrometheus — Aggregate all threads and emit text format 0.0.4.
+     *
+     * Alongside each `_total` counter a `_per_second` gauge reports the rate
+     * since the previous scrape, for dashboards that do not use rate().
+     */
+    std::string renderPrometheus() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        std::vector<uint64_t> totals(counters_.size(), 0);
+        for (const auto& block : blocks_)
+            for (std::size_t i = 0; i < counters_.size(); ++i)
+                totals[i] += block->values[i].load(std::memory_order_relaxed);
+
+        const auto now = std::chrono::steady_clock::now();
+        const double elapsed = std::chrono::duration<double>(now - lastScrape_).count();
+        lastScrape_ = now;
+
+        std::ostringstream os;
+        for (std::size_t i = 0; i < counters_.size(); ++i) {
+            const auto& c = counters_[i];
+            os << "# HELP " << c.name << " " << c.help << "\n"
+               << "# TYPE " << c.name << " counter\n"
+               << c.name << " " << totals[i] << "\n";
+
+            const std::string rate = rateName(c.name);
+            os << "# HELP " << rate << " " << c.help << " per second since the last scrape\n"
+               << "# TYPE " << rate << " gauge\n"
+               << rate << " "
+               << (elapsed > 0 ? static_cast<double>(totals[i] - lastTotals_[i]) / elapsed : 0.0)
+               << "\n";
+        }
+        lastTotals_ = totals;
+
+        for (const auto& info : info_)
+            os << "# TYPE " << info.name << " gauge\n"
+               << info.name << "{" << info.label << "=\"" << info.value << "\"} 1\n";
+
+        for (const auto& [name, reg] : latency_)
+            renderLatency(os, name, *reg);
+        return os.str();
+    }
+
+private:
+    struct Info { std::string name, label, value; };
+
+    static std::string rateName(const std::string& counter) {
+        const std::string suffix = "_total";
+        const bool hasSuffix = counter.size() > suffix.size()
+            && counter.compare(counter.size() - suffix.size(), suffix.size(), suffix) == 0;
+        return (hasSuffix ? counter.substr(0, counter.size() - suffix.size()) : counter)
+             + "_per_second";
+    }
+
+    static void renderLatency(std::ostream& os, const std::string& name,
+                              const LatencyRegistry& reg) {
+        // Bucket bounds in seconds (Prometheus convention), 1 µs … 100 ms.
+        static constexpr uint64_t kBoundsNs[] = {
+            1000, 2500, 5000, 10000, 25000, 50000, 100000, 250000, 500000,
+            1000000, 2500000, 5000000, 10000000, 25000000, 50000000, 100000000};
+
+        const auto snaps = reg.merge();
+        os << "# HELP " << name << " Pipeline stage latency in seconds\n"
+           << "# TYPE " << name << " histogram\n";
+        for (std::size_t s = 0; s < snaps.size(); ++s) {
+            const auto& h = snaps[s];
+            const std::string stage = "stage=\"" + reg.stages()[s] + "\"";
+            for (uint64_t bound : kBoundsNs)
+                os << name << "_bucket{" << stage << ",le=\"" << bound / 1e9 << "\"} "
+                   << h.countAtOrBelow(bound) << "\n";
+            os << name << "_bucket{" << stage << ",le=\"+Inf\"} " << h.count() << "\n"
+               << name << "_sum{" << stage << "} " << static_cast<double>(h.sum()) / 1e9 << "\n"
+               << name << "_count{" << stage << "} " << h.count() << "\n";
+        }
+    }
+
+    std::vector<MetricDesc> counters_;
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<CounterBlock>> blocks_;
+    std::vector<Info> info_;
+    std::vector<std::pair<std::string, const LatencyRegistry*>> latency_;
+    std::vector<uint64_t> lastTotals_;
+    std::chrono::steady_clock::time_point lastScrape_;
+};
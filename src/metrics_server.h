@@ -0,0 +1,109 @@
+// metrics_server.h — Minimal localhost HTTP endpoint for Prometheus scrapes
+//
+// One background thread, one connection at a time: scrapes arrive every few
+// seconds, so there is nothing to gain from a real HTTP stack. The server
+// binds to 127.0.0.1 only; in Kubernetes expose it to the Prometheus (or
+// Azure Monitor managed Prometheus) agent through a sidecar or port-forward.
+//
+//   GET /metrics  →  200, text/plain; version=0.0.4
+//   anything else →  404
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <thread>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+/**
+ * MetricsServer — Serve `render()` on http://127.0.0.1:<port>/metrics until
+ * destroyed.
+ */
+class MetricsServer {
+public:
+    MetricsServer(uint16_t port, std::function<std::string()> render)
+        : render_(std::move(render)) {
+        fd_ = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+        if (fd_ < 0) return;
+
+        const int one = 1;
+        ::setsockopt(fd_, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+        sockaddr_in addr{};
+        addr.sin_family      = AF_INET;
+        addr.sin_port        = htons(port);
+        addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        if (::bind(fd_, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0
+            || ::listen(fd_, 8) != 0) {
+            ::close(fd_);
+            fd_ = -1;
+            return;
+        }
+        thread_ = std::thread([this] { serve(); });
+    }
+
+    ~MetricsServer() {
+        stop_.store(true, std::memory_order_relaxed);
+        if (thread_.joinable()) thread_.join();
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    MetricsServer(const MetricsServer&) = delete;
+    MetricsServer& operator=(const MetricsServer&) = delete;
+
+    /** ok — False if the socket could not be bound (port in use, etc.). */
+    bool ok() const { return fd_ >= 0; }
+
+private:
+    void serve() {
+        while (!stop_.load(std::memory_order_relaxed)) {
+            // Poll with a timeout so the destructor never waits on accept().
+            pollfd pfd{fd_, POLLIN, 0};
+            if (::poll(&pfd, 1, 200) <= 0) continue;
+
+            const int conn = ::accept4(fd_, nullptr, nullptr, SOCK_CLOEXEC);
+            if (conn < 0) continue;
+            handle(conn);
+            ::close(conn);
+        }
+    }
+
+    void handle(int conn) {
+        char request[1024];
+        pollfd pfd{conn, POLLIN, 0};
+        if (::poll(&pfd, 1, 1000) <= 0) return;
+        const ssize_t n = ::recv(conn, request, sizeof(request) - 1, 0);
+        if (n <= 0) return;
+        request[n] = '\0';
+
+        const bool scrape = std::strncmp(request, "GET /metrics ", 13) == 0
+                         || std::strncmp(request, "GET /metrics?", 13) == 0;
+        const std::string body = scrape ? render_() : "not found\n";
+        const std::string response =
+            std::string(scrape ? "HTTP/1.1 200 OK\r\n" : "HTTP/1.1 404 Not Found\r\n")
+            + "Content-Type: text/plain; version=0.0.4\r\n"
+            + "Content-Length: " + std::to_string(body.size()) + "\r\n"
+            + "Connection: close\r\n\r\n" + body;
+
+        std::size_t sent = 0;
+        while (sent < response.size()) {
+            const ssize_t w = ::send(conn, response.data() + sent,
+                                     response.size() - sent, MSG_NOSIGNAL);
+            if (w <= 0) break;
+            sent += static_cast<std::size_t>(w);
+        }
+    }
+
+    std::function<std::string()> render_;
+    int fd_ = -1;
+    std::atomic<bool> stop_{false};
+    std::thread thread_;
+};
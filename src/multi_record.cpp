@@ -0,0 +1,174 @@
+// multi_record.cpp — Record-type dispatch for multi-record exports
+
+#include "multi_record.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <sstream>
+
+#include "txn_batch.h"
+
+namespace {
+
+// One handler per RecordKind; `payload` points at the 16-byte payload.
+using Handler = void (*)(const char* payload, SplitBatch& out);
+
+void onUnknown(const char*, SplitBatch& out) { ++out.unknown; }
+
+void onHeader(const char* p, SplitBatch& out) {
+    ExportHeader h;
+    h.fileDate = loadBigEndian<uint32_t>(p);
+    h.sequence = loadBigEndian<uint32_t>(p + 4);
+    std::memcpy(h.source, p + 8, sizeof(h.source));
+    out.headers.push_back(h);
+}
+
+void onTxn(const char* p, SplitBatch& out) {
+    // txnRaw is sized for the whole batch by split(); decoded later in bulk
+    std::memcpy(out.txnRaw.data() + out.txns * sizeof(TxnRecord), p, sizeof(TxnRecord));
+    ++out.txns;
+}
+
+void onVoid(const char* p, SplitBatch& out) {
+    VoidRecord v{};
+    v.txnId       = loadBigEndian<uint32_t>(p);
+    v.amountCents = loadBigEndian<uint32_t>(p + 4);
+    v.storeNumber = loadBigEndian<uint16_t>(p + 8);
+    v.reasonCode  = loadBigEndian<uint16_t>(p + 10);
+    out.voids.push_back(v);
+}
+
+void onTrailer(const char* p, SplitBatch& out) {
+    ExportTrailer t;
+    t.recordCount    = loadBigEndian<uint32_t>(p);
+    t.txnCount       = loadBigEndian<uint32_t>(p + 4);
+    t.netAmountCents = loadBigEndian<uint64_t>(p + 8);
+    out.trailers.push_back(t);
+}
+
+constexpr Handler kHandlers[kRecordKinds] = {onUnknown, onHeader, onTxn, onVoid, onTrailer};
+
+const char* const kKindNames[kRecordKinds] = {"", "header", "txn", "void", "trailer"};
+
+}  // namespace
+
+bool parseRecordLayout(const std::string& spec, RecordLayout& layout, std::string& error) {
+    std::istringstream in(spec);
+    std::string item;
+    while (std::getline(in, item, ',')) {
+        const std::size_t eq = item.find('=');
+        const std::string key   = item.substr(0, eq);
+        const std::string value = eq == std::string::npos ? "" : item.substr(eq + 1);
+        if (value.empty()) {
+            error = "expected key=value, got '" + item + "'";
+            return false;
+        }
+        const unsigned long number = std::strtoul(value.c_str(), nullptr, 0);
+
+        std::size_t* field = key == "length"  ? &layout.length
+                           : key == "offset"  ? &layout.typeOffset
+                           : key == "width"   ? &layout.typeWidth
+                           : key == "payload" ? &layout.payloadOffset
+                           : nullptr;
+        if (field) {
+            *field = number;
+            continue;
+        }
+        std::size_t kind = 1;
+        while (kind < kRecordKinds && key != kKindNames[kind]) ++kind;
+        if (kind == kRecordKinds) {
+            error = "unknown layout key '" + key + "'";
+            return false;
+        }
+        // A lone non-digit is a character code; anything else is a number
+        const bool isChar = value.size() == 1 && (value[0] < '0' || value[0] > '9');
+        layout.codes[kind] = static_cast<uint16_t>(isChar ? static_cast<unsigned char>(value[0])
+                                                          : number);
+    }
+
+    if (layout.typeWidth != 1 && layout.typeWidth != 2) {
+        error = "type width must be 1 or 2";
+        return false;
+    }
+    if (layout.typeOffset + layout.typeWidth > layout.length
+        || layout.payloadOffset + sizeof(TxnRecord) > layout.length) {
+        error = "type code or payload does not fit in the record length";
+        return false;
+    }
+    return true;
+}
+
+RecordDispatcher::RecordDispatcher(const RecordLayout& layout)
+    : layout_(layout), kindOf_(std::size_t{1} << (8 * layout.typeWidth), kRecordUnknown) {
+    for (std::size_t kind = 1; kind < kRecordKinds; ++kind)
+        if (layout_.codes[kind] < kindOf_.size())
+            kindOf_[layout_.codes[kind]] = static_cast<uint8_t>(kind);
+}
+
+void RecordDispatcher::split(const char* raw, std::size_t count, SplitBatch& out) const {
+    out.txnRaw.resize(count * sizeof(TxnRecord));
+    out.txns    = 0;
+    out.unknown = 0;
+    out.headers.clear();
+    out.voids.clear();
+    out.trailers.clear();
+    out.marks.clear();
+
+    const std::size_t len = layout_.length, payload = layout_.payloadOffset;
+    const char* type = raw + layout_.typeOffset;
+    auto route = [&](std::size_t i, uint8_t kind) {
+        if (kind == kRecordHeader || kind == kRecordTrailer)
+            out.marks.push_back({static_cast<RecordKind>(kind), i, out.txns, out.voids.size()});
+        kHandlers[kind](raw + payload, out);
+    };
+    if (layout_.typeWidth == 1) {
+        for (std::size_t i = 0; i < count; ++i, raw += len, type += len)
+            route(i, kindOf_[static_cast<unsigned char>(*type)]);
+    } else {
+        for (std::size_t i = 0; i < count; ++i, raw += len, type += len)
+            route(i, kindOf_[loadBigEndian<uint16_t>(type)]);
+    }
+}
+
+std::vector<char> generateMultiExport(std::size_t txns, const RecordLayout& layout) {
+    constexpr std::size_t kVoidEvery = 97;
+    const std::size_t voids   = txns / kVoidEvery;
+    const std::size_t records = txns + voids + 2;
+    std::vector<char> raw(records * layout.length, ' ');
+    const std::vector<char> body = generateExport(txns);
+
+    std::size_t next = 0;
+    auto emit = [&](RecordKind kind) {
+        char* rec = raw.data() + next++ * layout.length;
+        if (layout.typeWidth == 1)
+            rec[layout.typeOffset] = static_cast<char>(layout.codes[kind]);
+        else
+            storeBigEndian<uint16_t>(rec + layout.typeOffset, layout.codes[kind]);
+        return rec + layout.payloadOffset;
+    };
+
+    char* header = emit(kRecordHeader);
+    storeBigEndian<uint32_t>(header, 20260101);
+    storeBigEndian<uint32_t>(header + 4, 1);
+    std::memcpy(header + 8, "POS00001", 8);
+
+    uint64_t net = 0;
+    for (std::size_t i = 0; i < txns; ++i) {
+        const char* txn = body.data() + i * sizeof(TxnRecord);
+        std::memcpy(emit(kRecordTxn), txn, sizeof(TxnRecord));
+        net += loadBigEndian<uint32_t>(txn + 4);
+        if ((i + 1) % kVoidEvery == 0) {
+            char* v = emit(kRecordVoid);
+            std::memcpy(v, txn, 10);               // txnId, amount, store
+            storeBigEndian<uint16_t>(v + 10, 1);   // reason: customer cancelled
+            std::memset(v + 12, 0, 4);
+            net -= loadBigEndian<uint32_t>(txn + 4);
+        }
+    }
+
+    char* trailer = emit(kRecordTrailer);
+    storeBigEndian<uint32_t>(trailer, static_cast<uint32_t>(records));
+    storeBigEndian<uint32_t>(trailer + 4, static_cast<uint32_t>(txns));
+    storeBigEndian<uint64_t>(trailer + 8, net);
+    return raw;
+}
@@ -0,0 +1,127 @@
+// multi_record.h — Exports that interleave several record formats
+//
+// Real OS/400 exports are not all TxnRecords: a file starts with a header,
+// voids follow the transactions they cancel, and a trailer carries control
+// totals. Every record has the same length and a type code at a fixed
+// position, followed by the 16-byte Big-Endian payload of that type:
+//
+//   ┌──────┬───────────── payload (16 bytes) ──────────────┐
+//   │ type │ ExportHeader | TxnRecord | VoidRecord | ExportTrailer
+//   └──────┴────────────────────────────────────────────────┘
+//
+// RecordDispatcher::split classifies each record through a dense table
+// indexed by the raw type code (256 or 65536 entries) and calls the handler
+// for its kind from a function-pointer table — no virtual call, no branch
+// chain. TxnRecord payloads are only copied, still Big-Endian, into one
+// contiguous run per batch so decodeBatch keeps its SIMD shuffle; the rare
+// kinds are decoded on the spot.
+//
+// The layout is configurable (RecordLayout / parseRecordLayout):
+//   "length=17,offset=0,width=1,payload=1,header=H,txn=T,void=V,trailer=Z"
+// Codes are a single character (EBCDIC exports: use the numeric byte, e.g.
+// txn=0xE3) or a number for 2-byte fields.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "txn_record.h"
+
+enum RecordKind : uint8_t {
+    kRecordUnknown, kRecordHeader, kRecordTxn, kRecordVoid, kRecordTrailer, kRecordKinds
+};
+
+/** RecordLayout — Where the type code and payload sit in each record. */
+struct RecordLayout {
+    std::size_t length        = 17;  // bytes per record, type code included
+    std::size_t typeOffset    = 0;
+    std::size_t typeWidth     = 1;   // 1 or 2 (Big-Endian)
+    std::size_t payloadOffset = 1;
+    uint16_t    codes[kRecordKinds] = {0, 'H', 'T', 'V', 'Z'};
+};
+
+/**
+ * parseRecordLayout — Read comma-separated key=value overrides of the
+ * defaults; false (with `error` set) on an unknown key or a layout whose
+ * fields do not fit in `length`.
+ */
+bool parseRecordLayout(const std::string& spec, RecordLayout& layout, std::string& error);
+
+/** ExportHeader — First record of an export. */
+struct ExportHeader {
+    uint32_t fileDate;      // YYYYMMDD
+    uint32_t sequence;      // export number
+    char     source[8];     // originating system, blank padded
+};
+
+/** VoidRecord — Cancels an earlier transaction of the same export. */
+struct VoidRecord {
+    uint32_t txnId;
+    uint32_t amountCents;
+    uint16_t storeNumber;
+    uint16_t reasonCode;
+    char     reserved[4];
+};
+
+/** ExportTrailer — Control totals of everything since the header. */
+struct ExportTrailer {
+    uint32_t recordCount;   // all records, header and trailer included
+    uint32_t txnCount;
+    uint64_t netAmountCents; // transactions minus voids
+};
+
+static_assert(sizeof(ExportHeader) == 16 && sizeof(VoidRecord) == 16
+              && sizeof(ExportTrailer) == 16, "payloads are 16 bytes on disk");
+
+/**
+ * SplitBatch — One batch of a multi-record export, separated by kind.
+ * Reused across batches; split() clears it.
+ *
+ * `marks` keeps the batch's record order where it matters: for each header
+ * and trailer, how many records, transactions and voids came before it, so
+ * a batch holding several header/trailer groups can be accounted group by
+ * group.
+ */
+struct SplitBatch {
+    struct Mark {
+        RecordKind  kind;       // kRecordHeader or kRecordTrailer
+        std::size_t record;     // its position in the batch
+        std::size_t txns;       // transactions before it in the batch
+        std::size_t voids;      // voids before it in the batch
+    };
+
+    std::vector<char>          txnRaw;   // Big-Endian TxnRecords, contiguous
+    std::size_t                txns = 0;
+    std::vector<ExportHeader>  headers;
+    std::vector<VoidRecord>    voids;
+    std::vector<ExportTrailer> trailers;
+    std::vector<Mark>          marks;    // headers and trailers, in record order
+    std::size_t                unknown = 0;
+};
+
+/**
+ * RecordDispatcher — Type-code → kind table for one layout, and the batch
+ * splitter that uses it.
+ */
+class RecordDispatcher {
+public:
+    explicit RecordDispatcher(const RecordLayout& layout);
+
+    const RecordLayout& layout() const { return layout_; }
+
+    /** split — Classify and route `count` records starting at `raw`. */
+    void split(const char* raw, std::size_t count, SplitBatch& out) const;
+
+private:
+    RecordLayout         layout_;
+    std::vector<uint8_t> kindOf_;   // indexed by the raw type code
+};
+
+/**
+ * generateMultiExport — Header, `txns` TxnRecords (as generateExport) with a
+ * void after every 97th, and a matching trailer, in `layout`.
+ */
+std::vector<char> generateMultiExport(std::size_t txns, const RecordLayout& layout);
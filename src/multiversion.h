@@ -0,0 +1,43 @@
+// multiversion.h — Per-ISA-level function versions with runtime dispatch
+//
+// One portable binary, several compiled bodies: the loader's ifunc resolver
+// checks the host CPU once at startup and binds each multi-versioned
+// function to the best x86-64 micro-architecture level it supports:
+//
+//   x86-64-v2   SSE4.2, SSSE3 (pshufb), POPCNT      — Nehalem and later
+//   x86-64-v3   AVX2, BMI2, FMA                      — Haswell / Zen and later
+//   x86-64-v4   AVX-512 F/BW/CD/DQ/VL                — Skylake-SP / Ice Lake / Zen 4
+//
+// POS_TARGET_CLONES   compile one body once per level (auto-vectorized for each)
+// POS_TARGET(level)   mark one hand-chosen body of a versioned function
+//
+// Requires GCC 12+ on x86-64 ELF (glibc ifunc). Elsewhere, or with
+// -DPOS_NO_MULTIVERSION (CMake: -DPOS_MULTIVERSION=OFF), the macros expand
+// to nothing and only the default body is built.
+
+#pragma once
+
+#if !defined(POS_NO_MULTIVERSION) && defined(__x86_64__) && defined(__ELF__) \
+    && defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 12
+#  define POS_HAVE_MULTIVERSION 1
+#  define POS_TARGET_CLONES \
+       __attribute__((target_clones("arch=x86-64-v4", "arch=x86-64-v3", "arch=x86-64-v2", "default")))
+#  define POS_TARGET(level) __attribute__((target(level)))
+#else
+#  define POS_TARGET_CLONES
+#  define POS_TARGET(level)
+#endif
+
+/**
+ * multiversionLevel — The ISA level the resolvers selected on this host
+ * ("x86-64-v3", …), or "default" when multi-versioning is off.
+ */
+inline const char* multiversionLevel() {
+#if defined(POS_HAVE_MULTIVERSION)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("x86-64-v4")) return "x86-64-v4";
+    if (__builtin_cpu_supports("x86-64-v3")) return "x86-64-v3";
+    if (__builtin_cpu_supports("x86-64-v2")) return "x86-64-v2";
+#endif
+    return "default";
+}
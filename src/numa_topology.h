@@ -0,0 +1,217 @@
+// numa_topology.h — NUMA nodes, thread pinning and page placement (Linux)
+//
+// On a multi-socket host a thread that decodes memory owned by the other
+// socket pays a remote-DRAM round trip per cache line. The partitioned
+// pipeline avoids that by giving every node a contiguous slice of the
+// export, pinning that slice's workers to cores of the same node, and
+// placing the slice's pages on that node.
+//
+// Everything here reads sysfs and calls sched_setaffinity / mbind directly,
+// so no libnuma is needed at build or run time. On hosts without NUMA
+// information (containers, non-Linux) the topology is one node holding every
+// CPU the process may run on, and placement calls are no-ops.
+//
+// Placement policies:
+//   kLocal       each worker first-touches its chunk into a buffer it
+//                allocates after pinning, so the pages land on its node
+//   kInterleave  the whole export is spread page-by-page over all nodes
+//                (mbind MPOL_INTERLEAVE); workers still pin
+//   kOff         no pinning, no placement
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#if defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+enum class NumaPolicy { kOff, kLocal, kInterleave };
+
+struct NumaNode {
+    int              id = 0;
+    std::vector<int> cpus;   // CPUs of this node the process may run on
+};
+
+/** parseCpuList — "0-3,8,10-11" → {0,1,2,3,8,10,11}. */
+inline std::vector<int> parseCpuList(const std::string& list) {
+    std::vector<int> cpus;
+    std::istringstream in(list);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        if (range.empty() || range == "\n") continue;
+        const std::size_t dash = range.find('-');
+        const int lo = std::atoi(range.c_str());
+        const int hi = dash == std::string::npos ? lo : std::atoi(range.c_str() + dash + 1);
+        for (int c = lo; c <= hi; ++c) cpus.push_back(c);
+    }
+    return cpus;
+}
+
+/**
+ * NumaTopology — Online nodes with at least one usable CPU, in node order.
+ */
+class NumaTopology {
+public:
+    static NumaTopology detect() {
+        NumaTopology topo;
+#if defined(__linux__)
+        cpu_set_t allowed;
+        CPU_ZERO(&allowed);
+        const bool haveMask = ::sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+        auto usable = [&](int cpu) {
+            return !haveMask || (cpu < CPU_SETSIZE && CPU_ISSET(cpu, &allowed));
+        };
+
+        std::ifstream online("/sys/devices/system/node/online");
+        std::string list;
+        if (online && std::getline(online, list)) {
+            for (int id : parseCpuList(list)) {
+                std::ifstream cpulist("/sys/devices/system/node/node" + std::to_string(id)
+                                      + "/cpulist");
+                std::string cpus;
+                if (!cpulist || !std::getline(cpulist, cpus)) continue;
+                NumaNode node{id, {}};
+                for (int cpu : parseCpuList(cpus))
+                    if (usable(cpu)) node.cpus.push_back(cpu);
+                if (!node.cpus.empty()) topo.nodes_.push_back(std::move(node));
+            }
+        }
+        if (topo.nodes_.empty() && haveMask) {
+            NumaNode node;
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+                if (CPU_ISSET(cpu, &allowed)) node.cpus.push_back(cpu);
+            topo.nodes_.push_back(std::move(node));
+        }
+#endif
+        if (topo.nodes_.empty()) topo.nodes_.push_back(NumaNode{0, {0}});
+        return topo;
+    }
+
+    std::size_t     nodes() const { return nodes_.size(); }
+    const NumaNode& node(std::size_t i) const { return nodes_[i]; }
+
+    /** cpus — Total usable CPUs across all nodes. */
+    std::size_t cpus() const {
+        std::size_t n = 0;
+        for (const auto& node : nodes_) n += node.cpus.size();
+        return n;
+    }
+
+    /** firstNode — The same host restricted to its first node (single-socket baseline). */
+    NumaTopology firstNode() const {
+        NumaTopology one;
+        one.nodes_.push_back(nodes_.front());
+        return one;
+    }
+
+    /**
+     * nodeForThread — Threads are split into contiguous blocks, one per node,
+     * so neighbouring chunks of the export stay on the same node.
+     */
+    std::size_t nodeForThread(std::size_t thread, std::size_t threads) const {
+        return thread * nodes_.size() / threads;
+    }
+
+private:
+    std::vector<NumaNode> nodes_;
+};
+
+/** pinThreadToCpu — Restrict the calling thread to one CPU; false on failure. */
+inline bool pinThreadToCpu(int cpu) {
+#if defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return ::pthread_setaffinity_np(::pthread_self(), sizeof(set), &set) == 0;
+#else
+    (void)cpu;
+    return false;
+#endif
+}
+
+/**
+ * PageBuffer — Anonymous, page-aligned mapping whose pages are placed on
+ * first touch (or by interleave()). Move-only.
+ */
+class PageBuffer {
+public:
+    PageBuffer() = default;
+    explicit PageBuffer(std::size_t bytes) : size_(bytes) {
+        if (bytes == 0) return;
+#if defined(__linux__)
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                         MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        data_ = p == MAP_FAILED ? nullptr : static_cast<char*>(p);
+#else
+        data_ = static_cast<char*>(std::malloc(bytes));
+#endif
+        if (!data_) size_ = 0;
+    }
+    PageBuffer(PageBuffer&& o) noexcept : data_(o.data_), size_(o.size_) {
+        o.data_ = nullptr;
+        o.size_ = 0;
+    }
+    PageBuffer& operator=(PageBuffer&& o) noexcept {
+        if (this != &o) {
+            release();
+            data_ = o.data_;
+            size_ = o.size_;
+            o.data_ = nullptr;
+            o.size_ = 0;
+        }
+        return *this;
+    }
+    PageBuffer(const PageBuffer&) = delete;
+    PageBuffer& operator=(const PageBuffer&) = delete;
+    ~PageBuffer() { release(); }
+
+    char*       data()       { return data_; }
+    const char* data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    /**
+     * interleave — Spread not-yet-touched pages round-robin over the nodes of `topo`
+     * (MPOL_INTERLEAVE). Call before writing the buffer; false if refused.
+     */
+    bool interleave(const NumaTopology& topo) {
+#if defined(__linux__) && defined(SYS_mbind)
+        constexpr int kMpolInterleave = 3;
+        constexpr std::size_t kBits = 8 * sizeof(unsigned long);
+        unsigned long mask[16] = {};
+        for (std::size_t i = 0; i < topo.nodes(); ++i) {
+            const auto id = static_cast<std::size_t>(topo.node(i).id);
+            if (id < 16 * kBits) mask[id / kBits] |= 1ul << (id % kBits);
+        }
+        return data_ && ::syscall(SYS_mbind, data_, size_, kMpolInterleave, mask,
+                                  16 * kBits + 1, 0u) == 0;
+#else
+        (void)topo;
+        return false;
+#endif
+    }
+
+private:
+    void release() {
+        if (!data_) return;
+#if defined(__linux__)
+        ::munmap(data_, size_);
+#else
+        std::free(data_);
+#endif
+        data_ = nullptr;
+    }
+
+    char*       data_ = nullptr;
+    std::size_t size_ = 0;
+};
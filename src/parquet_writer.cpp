@@ -0,0 +1,592 @@
+// parquet_writer.cpp — Parquet encodings, pages and Thrift footer
+//
+// Layout of the file (Parquet format specification, parquet.thrift):
+//
+//   "PAR1"  row group 0 … row group N  FileMetaData  footer length  "PAR1"
+//
+// where every column chunk is an optional dictionary page followed by data
+// pages, each page a Thrift PageHeader plus its body. All metadata uses the
+// Thrift compact protocol. Columns are REQUIRED, so data pages carry no
+// definition or repetition levels.
+
+#include "parquet_writer.h"
+
+#include <algorithm>
+#include <bit>
+#include <climits>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <string_view>
+#include <type_traits>
+
+#include "ebcdic.h"
+#include "txn_record.h"
+
+namespace {
+
+// parquet.thrift enums
+enum ParquetType : int32_t { kInt32 = 1, kByteArray = 6 };
+enum Encoding : int32_t {
+    kPlain = 0, kRle = 3, kDeltaBinaryPacked = 5, kRleDictionary = 8
+};
+enum PageType : int32_t { kDataPage = 0, kDictionaryPage = 2 };
+enum ConvertedType : int32_t { kUtf8 = 0, kUint16 = 12, kUint32 = 13 };
+
+constexpr std::size_t kPageRows      = std::size_t{1} << 16;
+constexpr std::size_t kMaxDictionary = std::size_t{1} << 16;
+
+/** zigzag — Signed → unsigned varint mapping (0, -1, 1, -2, …), as Thrift and Parquet use. */
+uint64_t zigzag(int64_t v) {
+    return (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63);
+}
+
+// ---------------------------------------------------------------------------
+// Thrift compact protocol, write-only
+// ---------------------------------------------------------------------------
+
+class ThriftWriter {
+public:
+    enum Type : uint8_t { kTrue = 1, kFalse = 2, kByte = 3, kI32 = 5, kI64 = 6,
+                          kBinary = 8, kList = 9, kStruct = 12 };
+
+    explicit ThriftWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void i32(int16_t id, int32_t v)             { field(id, kI32); varint(zigzag(v)); }
+    void i64(int16_t id, int64_t v)             { field(id, kI64); varint(zigzag(v)); }
+    void byte(int16_t id, int8_t v)             { field(id, kByte); out_.push_back(static_cast<uint8_t>(v)); }
+    void boolean(int16_t id, bool v)            { field(id, v ? kTrue : kFalse); }
+    void binary(int16_t id, std::string_view v) { field(id, kBinary); bytes(v); }
+
+    void beginStruct(int16_t id) { field(id, kStruct); beginElement(); }
+    void endStruct()             { endElement(); }
+
+    /** beginList — List header; write the elements with the element methods. */
+    void beginList(int16_t id, Type element, std::size_t size) {
+        field(id, kList);
+        if (size < 15) {
+            out_.push_back(static_cast<uint8_t>(size << 4 | element));
+        } else {
+            out_.push_back(static_cast<uint8_t>(0xF0 | element));
+            varint(size);
+        }
+    }
+
+    // List elements (and the outermost struct: beginElement … endElement)
+    void beginElement()                  { lastId_.push_back(0); }
+    void endElement()                    { out_.push_back(0); lastId_.pop_back(); }
+    void elementI32(int32_t v)           { varint(zigzag(v)); }
+    void elementBinary(std::string_view v) { bytes(v); }
+
+private:
+    void field(int16_t id, Type type) {
+        const int delta = id - lastId_.back();
+        if (delta > 0 && delta <= 15) {
+            out_.push_back(static_cast<uint8_t>(delta << 4 | type));
+        } else {
+            out_.push_back(type);
+            varint(zigzag(id));
+        }
+        lastId_.back() = id;
+    }
+
+    void varint(uint64_t v) {
+        for (; v >= 0x80; v >>= 7) out_.push_back(static_cast<uint8_t>(v | 0x80));
+        out_.push_back(static_cast<uint8_t>(v));
+    }
+
+    void bytes(std::string_view v) {
+        varint(v.size());
+        out_.insert(out_.end(), v.begin(), v.end());
+    }
+
+    std::vector<uint8_t>& out_;
+    std::vector<int16_t>  lastId_;
+};
+
+// ---------------------------------------------------------------------------
+// Encodings
+// ---------------------------------------------------------------------------
+
+void appendVarint(std::vector<uint8_t>& out, uint64_t v) {
+    for (; v >= 0x80; v >>= 7) out.push_back(static_cast<uint8_t>(v | 0x80));
+    out.push_back(static_cast<uint8_t>(v));
+}
+
+
+/** storeLe64 — `v` at `p` in little-endian byte order (one store on x86). */
+void storeLe64(uint8_t* p, uint64_t v) {
+    if constexpr (std::endian::native == std::endian::big) v = byteswapPortable(v);
+    std::memcpy(p, &v, 8);
+}
+
+/**
+ * bitPack — Append `count` values (a multiple of 8) of `width` bits each,
+ * least significant bit first, as both RLE-hybrid bit-packed runs and delta
+ * miniblocks store them. Up to 8 bits wide — every dictionary this writer
+ * sees in practice — each group of 8 values is assembled in one word.
+ */
+void bitPack(std::vector<uint8_t>& out, const uint32_t* values, std::size_t count, unsigned width) {
+    const std::size_t at = out.size(), bytes = count * width / 8;
+    if (width == 0) return;
+    if (width <= 8) {
+        out.resize(at + bytes + 8);          // every group stores a full word
+        uint8_t* p = out.data() + at;
+        for (std::size_t i = 0; i < count; i += 8, p += width) {
+            uint64_t word = 0;
+            for (unsigned k = 0; k < 8; ++k) word |= uint64_t{values[i + k]} << (k * width);
+            storeLe64(p, word);
+        }
+        out.resize(at + bytes);
+        return;
+    }
+    out.resize(at + bytes);
+    uint8_t* p = out.data() + at;
+    uint64_t acc = 0;
+    unsigned bits = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        acc |= uint64_t{values[i]} << bits;
+        for (bits += width; bits >= 8; bits -= 8, acc >>= 8) *p++ = static_cast<uint8_t>(acc);
+    }
+}
+
+/** bitWidth — Bits needed for `maxValue`. */
+unsigned bitWidth(uint32_t maxValue) { return static_cast<unsigned>(std::bit_width(maxValue)); }
+
+/**
+ * encodeDelta — DELTA_BINARY_PACKED: blocks of 128 deltas in 4 miniblocks
+ * of 32, each miniblock bit-packed at its own width above the block's
+ * minimum delta. Arithmetic wraps at 32 bits, as readers decode INT32.
+ */
+void encodeDelta(std::vector<uint8_t>& out, const uint32_t* v, std::size_t n) {
+    constexpr std::size_t kBlock = 128, kMiniblocks = 4, kMini = kBlock / kMiniblocks;
+    appendVarint(out, kBlock);
+    appendVarint(out, kMiniblocks);
+    appendVarint(out, n);
+    appendVarint(out, zigzag(static_cast<int32_t>(v[0])));
+
+    uint32_t packed[kBlock];
+    for (std::size_t b = 1; b < n; b += kBlock) {
+        const std::size_t len = std::min(kBlock, n - b);
+        int32_t minDelta = INT32_MAX;
+        for (std::size_t k = 0; k < len; ++k) {
+            packed[k] = v[b + k] - v[b + k - 1];
+            minDelta  = std::min(minDelta, static_cast<int32_t>(packed[k]));
+        }
+        for (std::size_t k = 0; k < kBlock; ++k)
+            packed[k] = k < len ? packed[k] - static_cast<uint32_t>(minDelta) : 0;
+
+        appendVarint(out, zigzag(minDelta));
+        uint8_t widths[kMiniblocks] = {};
+        for (std::size_t m = 0; m * kMini < len; ++m) {
+            uint32_t bits = 0;                    // the OR has the maximum's width
+            for (std::size_t k = m * kMini; k < (m + 1) * kMini; ++k) bits |= packed[k];
+            widths[m] = static_cast<uint8_t>(bitWidth(bits));
+        }
+        out.insert(out.end(), widths, widths + kMiniblocks);
+        for (std::size_t m = 0; m * kMini < len; ++m)
+            bitPack(out, packed + m * kMini, kMini, widths[m]);
+    }
+}
+
+/**
+ * encodeIndices — An RLE_DICTIONARY data page body: the index bit width,
+ * then one RLE-hybrid bit-packed run (padded to a multiple of 8 values).
+ */
+void encodeIndices(std::vector<uint8_t>& out, const uint32_t* indices, std::size_t n, unsigned width) {
+    const std::size_t groups = (n + 7) / 8;
+    out.push_back(static_cast<uint8_t>(width));
+    appendVarint(out, groups << 1 | 1);
+    bitPack(out, indices, n & ~std::size_t{7}, width);
+    if (n % 8) {
+        uint32_t tail[8] = {};
+        std::copy(indices + (n & ~std::size_t{7}), indices + n, tail);
+        bitPack(out, tail, 8, width);
+    }
+}
+
+// ---------------------------------------------------------------------------
+// Column values
+//
+// Columns are uint32 or uint16 (INT32 in Parquet) or cardType (CardValue,
+// BYTE_ARRAY). Each value has a 32-bit key for the dictionary and a sort
+// key for the statistics: the value itself, or for strings the 4 bytes
+// read Big-Endian, which orders them bytewise as Parquet requires. Card
+// values stay Latin-1 up to here and are written as UTF-8, which keeps
+// that order.
+// ---------------------------------------------------------------------------
+
+/** CardValue — One 4-byte cardType value. */
+struct CardValue { char bytes[4]; };
+
+uint32_t keyOf(uint16_t v) { return v; }
+uint32_t keyOf(CardValue v) {
+    uint32_t key;
+    std::memcpy(&key, v.bytes, 4);
+    return key;
+}
+
+uint32_t sortKey(uint32_t v) { return v; }
+uint32_t sortKey(uint16_t v) { return v; }
+uint32_t sortKey(CardValue v) { return loadBigEndian<uint32_t>(v.bytes); }
+
+/** appendPlain — PLAIN encoding: little-endian INT32s, or length-prefixed strings. */
+template <typename T>
+void appendPlain(std::vector<uint8_t>& out, const T* v, std::size_t n) {
+    const std::size_t at = out.size();
+    if constexpr (std::is_same_v<T, CardValue>) {
+        out.resize(at + 12 * n);
+        uint8_t* p = out.data() + at;
+        for (std::size_t i = 0; i < n; ++i) {
+            const auto length = static_cast<uint8_t>(latin1ToUtf8(v[i].bytes, 4, reinterpret_cast<char*>(p + 4)));
+            const uint8_t prefix[4] = {length, 0, 0, 0};
+            std::memcpy(p, prefix, 4);
+            p += 4 + length;
+        }
+        out.resize(static_cast<std::size_t>(p - out.data()));
+    } else if constexpr (sizeof(T) == 4 && std::endian::native == std::endian::little) {
+        out.resize(at + 4 * n);
+        std::memcpy(out.data() + at, v, 4 * n);
+    } else {
+        out.resize(at + 4 * n);
+        uint8_t* p = out.data() + at;
+        for (std::size_t i = 0; i < n; ++i, p += 4)
+            for (int k = 0; k < 4; ++k) p[k] = static_cast<uint8_t>(uint32_t{v[i]} >> (8 * k));
+    }
+}
+
+/** setStatistics — min_value / max_value of `n` values, PLAIN-encoded. */
+template <typename T>
+void setStatistics(ParquetColumnChunk& chunk, const T* v, std::size_t n) {
+    uint32_t lo = UINT32_MAX, hi = 0;
+    for (std::size_t i = 0; i < n; ++i) {
+        lo = std::min(lo, sortKey(v[i]));
+        hi = std::max(hi, sortKey(v[i]));
+    }
+    char b[4];
+    const auto encode = [&](uint32_t key) {
+        if constexpr (std::is_same_v<T, CardValue>) {
+            char utf8[8];
+            storeBigEndian(b, key);                // the string's Latin-1 bytes
+            return std::string(utf8, latin1ToUtf8(b, 4, utf8));
+        } else {
+            for (int k = 0; k < 4; ++k) b[k] = static_cast<char>(key >> (8 * k));
+            return std::string(b, 4);
+        }
+    };
+    chunk.minValue = encode(lo);
+    chunk.maxValue = encode(hi);
+}
+
+/**
+ * Dictionary — Distinct values in first-seen order and their indices.
+ * uint16 values index a direct 64Ki-entry table; wider values an
+ * open-addressing hash table on their key.
+ */
+template <typename T>
+class Dictionary {
+public:
+    Dictionary() : slots_(kDirect ? std::size_t{1} << 16 : std::size_t{1} << kInitialBits, kEmpty) {}
+
+    /** index — The value's index, adding it if new. */
+    uint32_t index(T value) {
+        const uint32_t key = keyOf(value);
+        if constexpr (kDirect) {
+            uint32_t& slot = slots_[key];
+            if (slot == kEmpty) {
+                slot = static_cast<uint32_t>(values_.size());
+                values_.push_back(value);
+            }
+            return slot;
+        } else {
+            const std::size_t mask = slots_.size() - 1;
+            for (std::size_t s = hash(key);; s = (s + 1) & mask) {
+                const uint32_t slot = slots_[s];
+                if (slot == kEmpty) {
+                    slots_[s] = static_cast<uint32_t>(values_.size());
+                    keys_.push_back(key);
+                    values_.push_back(value);
+                    if (keys_.size() * 2 > slots_.size()) grow();
+                    return static_cast<uint32_t>(values_.size() - 1);
+                }
+                if (keys_[slot] == key) return slot;
+            }
+        }
+    }
+
+    const std::vector<T>& values() const { return values_; }
+
+private:
+    static constexpr bool     kDirect = sizeof(T) <= 2;
+    static constexpr uint32_t kEmpty  = UINT32_MAX;
+    static constexpr unsigned kInitialBits = 10;
+
+    std::size_t hash(uint32_t key) const { return (key * 0x9E3779B1u) >> (32 - bits_); }
+
+    void grow() {
+        slots_.assign(slots_.size() * 2, kEmpty);
+        ++bits_;
+        for (uint32_t i = 0; i < keys_.size(); ++i) {
+            std::size_t s = hash(keys_[i]);
+            while (slots_[s] != kEmpty) s = (s + 1) & (slots_.size() - 1);
+            slots_[s] = i;
+        }
+    }
+
+    std::vector<T>        values_;
+    std::vector<uint32_t> keys_;      // hashed only
+    std::vector<uint32_t> slots_;
+    unsigned              bits_ = kInitialBits;   // log2(slots_.size()) when hashed
+};
+
+// ---------------------------------------------------------------------------
+// Pages and column chunks
+// ---------------------------------------------------------------------------
+
+/** appendPage — PageHeader + body onto the chunk. */
+void appendPage(ParquetColumnChunk& chunk, PageType type, std::size_t values, Encoding encoding,
+                const std::vector<uint8_t>& body) {
+    ThriftWriter t(chunk.bytes);
+    t.beginElement();
+    t.i32(1, type);
+    t.i32(2, static_cast<int32_t>(body.size()));   // uncompressed_page_size
+    t.i32(3, static_cast<int32_t>(body.size()));   // compressed_page_size
+    if (type == kDataPage) {
+        t.beginStruct(5);                           // DataPageHeader
+        t.i32(1, static_cast<int32_t>(values));
+        t.i32(2, encoding);
+        t.i32(3, kRle);                             // definition levels (none written)
+        t.i32(4, kRle);                             // repetition levels (none written)
+        t.endStruct();
+    } else {
+        t.beginStruct(7);                           // DictionaryPageHeader
+        t.i32(1, static_cast<int32_t>(values));
+        t.i32(2, kPlain);
+        t.endStruct();
+    }
+    t.endElement();
+    chunk.bytes.insert(chunk.bytes.end(), body.begin(), body.end());
+}
+
+/** encodePlainColumn — PLAIN data pages. */
+template <typename T>
+ParquetColumnChunk encodePlainColumn(const T* v, std::size_t rows) {
+    ParquetColumnChunk chunk;
+    setStatistics(chunk, v, rows);
+    chunk.encodings = {kPlain, kRle};
+    chunk.bytes.reserve(rows * (std::is_same_v<T, CardValue> ? 8 : 4) + (rows / kPageRows + 1) * 32);
+    std::vector<uint8_t> body;
+    for (std::size_t p = 0; p < rows; p += kPageRows) {
+        const std::size_t n = std::min(kPageRows, rows - p);
+        body.clear();
+        appendPlain(body, v + p, n);
+        appendPage(chunk, kDataPage, n, kPlain, body);
+    }
+    return chunk;
+}
+
+/** encodeDeltaColumn — DELTA_BINARY_PACKED data pages. */
+ParquetColumnChunk encodeDeltaColumn(const uint32_t* v, std::size_t rows) {
+    ParquetColumnChunk chunk;
+    setStatistics(chunk, v, rows);
+    chunk.encodings = {kDeltaBinaryPacked, kRle};
+    std::vector<uint8_t> body;
+    for (std::size_t p = 0; p < rows; p += kPageRows) {
+        const std::size_t n = std::min(kPageRows, rows - p);
+        body.clear();
+        encodeDelta(body, v + p, n);
+        appendPage(chunk, kDataPage, n, kDeltaBinaryPacked, body);
+    }
+    return chunk;
+}
+
+/**
+ * encodeDictionaryColumn — Dictionary page + RLE_DICTIONARY data pages, or
+ * PLAIN once the dictionary outgrows kMaxDictionary.
+ */
+template <typename T>
+ParquetColumnChunk encodeDictionaryColumn(const T* v, std::size_t rows) {
+    Dictionary<T> dict;
+    const auto indices = std::make_unique_for_overwrite<uint32_t[]>(rows);
+    for (std::size_t p = 0; p < rows; p += kPageRows) {
+        const std::size_t end = std::min(rows, p + kPageRows);
+        for (std::size_t i = p; i < end; ++i) indices[i] = dict.index(v[i]);
+        if (dict.values().size() > kMaxDictionary) return encodePlainColumn(v, rows);
+    }
+
+    ParquetColumnChunk chunk;
+    const std::vector<T>& values = dict.values();
+    setStatistics(chunk, values.data(), values.size());
+    chunk.distinctCount = static_cast<int64_t>(values.size());
+    chunk.encodings = {kPlain, kRle, kRleDictionary};
+    chunk.dictionaryPage = 0;
+    std::vector<uint8_t> body;
+    appendPlain(body, values.data(), values.size());
+    appendPage(chunk, kDictionaryPage, values.size(), kPlain, body);
+
+    chunk.dataPage = static_cast<int64_t>(chunk.bytes.size());
+    const unsigned width = std::max(1u, bitWidth(static_cast<uint32_t>(values.size() - 1)));
+    chunk.bytes.reserve(chunk.bytes.size() + rows * width / 8 + (rows / kPageRows + 1) * 48);
+    for (std::size_t p = 0; p < rows; p += kPageRows) {
+        const std::size_t n = std::min(kPageRows, rows - p);
+        body.clear();
+        encodeIndices(body, indices.get() + p, n, width);
+        appendPage(chunk, kDataPage, n, kRleDictionary, body);
+    }
+    return chunk;
+}
+
+struct ColumnInfo {
+    const char*   name;
+    ParquetType   type;
+    ConvertedType converted;
+    int8_t        bitWidth;      // INTEGER logical type; 0 = STRING
+};
+
+constexpr ColumnInfo kColumns[] = {
+    {"txnId", kInt32, kUint32, 32},       {"amountCents", kInt32, kUint32, 32},
+    {"storeNumber", kInt32, kUint16, 16}, {"pumpNumber", kInt32, kUint16, 16},
+    {"cardType", kByteArray, kUtf8, 0},
+};
+
+}  // namespace
+
+// ---------------------------------------------------------------------------
+// ParquetWriter
+// ---------------------------------------------------------------------------
+
+ParquetWriter::ParquetWriter(std::ostream& out) : out_(out) {
+    out_.write("PAR1", 4);
+    bytes_ = 4;
+}
+
+ParquetWriter::~ParquetWriter() {
+    if (!finished_) finish();
+}
+
+ParquetRowGroup ParquetWriter::encode(const TxnArrowBatch& batch) {
+    const std::size_t rows = batch.length();
+    ParquetRowGroup group;
+    group.rows = rows;
+    if (rows == 0) return group;
+    group.columns.push_back(encodeDeltaColumn(batch.txnId(), rows));
+    group.columns.push_back(encodePlainColumn(batch.amountCents(), rows));
+    group.columns.push_back(encodeDictionaryColumn(batch.storeNumber(), rows));
+    group.columns.push_back(encodeDictionaryColumn(batch.pumpNumber(), rows));
+    group.columns.push_back(encodeDictionaryColumn(reinterpret_cast<const CardValue*>(batch.cardRaw()), rows));
+    return group;
+}
+
+void ParquetWriter::append(ParquetRowGroup&& group) {
+    if (group.rows == 0) return;
+    GroupMeta meta;
+    meta.rows = group.rows;
+    for (ParquetColumnChunk& chunk : group.columns) {
+        out_.write(reinterpret_cast<const char*>(chunk.bytes.data()),
+                   static_cast<std::streamsize>(chunk.bytes.size()));
+        GroupMeta::Chunk c;
+        c.fileOffset = static_cast<int64_t>(bytes_);
+        c.size       = static_cast<int64_t>(chunk.bytes.size());
+        bytes_      += chunk.bytes.size();
+        std::vector<uint8_t>().swap(chunk.bytes);
+        c.meta = std::move(chunk);
+        meta.chunks.push_back(std::move(c));
+    }
+    groups_.push_back(std::move(meta));
+}
+
+bool ParquetWriter::finish() {
+    if (finished_) return static_cast<bool>(out_);
+    finished_ = true;
+
+    std::size_t totalRows = 0;
+    for (const GroupMeta& g : groups_) totalRows += g.rows;
+
+    std::vector<uint8_t> footer;
+    ThriftWriter t(footer);
+    t.beginElement();                                           // FileMetaData
+    t.i32(1, 1);                                                // version
+    t.beginList(2, ThriftWriter::kStruct, std::size(kColumns) + 1);
+    t.beginElement();                                           // root SchemaElement
+    t.binary(4, "schema");
+    t.i32(5, static_cast<int32_t>(std::size(kColumns)));
+    t.endElement();
+    for (const ColumnInfo& col : kColumns) {
+        t.beginElement();
+        t.i32(1, col.type);
+        t.i32(3, 0);                                            // REQUIRED
+        t.binary(4, col.name);
+        t.i32(6, col.converted);
+        t.beginStruct(10);                                      // LogicalType union
+        if (col.bitWidth) {
+            t.beginStruct(10);                                  // INTEGER
+            t.byte(1, col.bitWidth);
+            t.boolean(2, false);
+        } else {
+            t.beginStruct(1);                                   // STRING
+        }
+        t.endStruct();
+        t.endStruct();
+        t.endElement();
+    }
+    t.i64(3, static_cast<int64_t>(totalRows));
+    t.beginList(4, ThriftWriter::kStruct, groups_.size());
+    for (const GroupMeta& g : groups_) {
+        t.beginElement();                                       // RowGroup
+        int64_t groupBytes = 0;
+        for (const GroupMeta::Chunk& c : g.chunks) groupBytes += c.size;
+        t.beginList(1, ThriftWriter::kStruct, g.chunks.size());
+        for (std::size_t i = 0; i < g.chunks.size(); ++i) {
+            const GroupMeta::Chunk& c = g.chunks[i];
+            const ColumnInfo& col = kColumns[i];
+            t.beginElement();                                   // ColumnChunk
+            t.i64(2, c.fileOffset);
+            t.beginStruct(3);                                   // ColumnMetaData
+            t.i32(1, col.type);
+            t.beginList(2, ThriftWriter::kI32, c.meta.encodings.size());
+            for (int32_t e : c.meta.encodings) t.elementI32(e);
+            t.beginList(3, ThriftWriter::kBinary, 1);
+            t.elementBinary(col.name);
+            t.i32(4, 0);                                        // UNCOMPRESSED
+            t.i64(5, static_cast<int64_t>(g.rows));
+            t.i64(6, c.size);
+            t.i64(7, c.size);
+            t.i64(9, c.fileOffset + c.meta.dataPage);
+            if (c.meta.dictionaryPage >= 0) t.i64(11, c.fileOffset + c.meta.dictionaryPage);
+            t.beginStruct(12);                                  // Statistics
+            t.i64(3, 0);                                        // null_count
+            if (c.meta.distinctCount >= 0) t.i64(4, c.meta.distinctCount);
+            t.binary(5, c.meta.maxValue);
+            t.binary(6, c.meta.minValue);
+            t.endStruct();
+            t.endStruct();
+            t.endElement();
+        }
+        t.i64(2, groupBytes);                                   // total_byte_size
+        t.i64(3, static_cast<int64_t>(g.rows));
+        t.i64(5, g.chunks.empty() ? 0 : g.chunks.front().fileOffset);
+        t.i64(6, groupBytes);                                   // total_compressed_size
+        t.endElement();
+    }
+    t.binary(6, "pos_modern version 1.0.0");                   // created_by
+    // TypeDefinedOrder for every column: min_value/max_value are meaningful
+    // (unsigned for the UINT columns, bytewise for cardType)
+    t.beginList(7, ThriftWriter::kStruct, std::size(kColumns));
+    for (std::size_t i = 0; i < std::size(kColumns); ++i) {
+        t.beginElement();                                       // ColumnOrder union
+        t.beginStruct(1);                                       // TYPE_ORDER
+        t.endStruct();
+        t.endElement();
+    }
+    t.endElement();
+
+    const auto length = static_cast<uint32_t>(footer.size());
+    const char tail[8] = {static_cast<char>(length), static_cast<char>(length >> 8),
+                          static_cast<char>(length >> 16), static_cast<char>(length >> 24),
+                          'P', 'A', 'R', '1'};
+    out_.write(reinterpret_cast<const char*>(footer.data()), static_cast<std::streamsize>(footer.size()));
+    out_.write(tail, 8);
+    bytes_ += footer.size() + 8;
+    out_.flush();
+    return static_cast<bool>(out_);
+}
@@ -0,0 +1,97 @@
+// parquet_writer.h — Decoded TxnRecords as Parquet archives
+//
+// Nightly exports are archived as Parquet so they can be queried in place.
+// The five columns match the Arrow output (arrow_ipc.h), and each one is
+// encoded to suit its data:
+//
+//   txnId        INT32 UINT_32   DELTA_BINARY_PACKED (sequential ids pack
+//                                to almost nothing)
+//   amountCents  INT32 UINT_32   PLAIN
+//   storeNumber  INT32 UINT_16   dictionary (RLE_DICTIONARY)
+//   pumpNumber   INT32 UINT_16   dictionary
+//   cardType     BYTE_ARRAY UTF8 dictionary
+//
+// A dictionary column falls back to PLAIN in any row group where it has
+// more than 64Ki distinct values. Every column chunk carries min/max,
+// null-count and (for dictionary columns) distinct-count statistics, so
+// readers can skip row groups on predicates. Pages are uncompressed.
+//
+// Row groups are encoded independently: ParquetWriter::encode is a pure
+// function of one TxnArrowBatch, so callers encode several row groups on
+// different threads and append() them in order. append() writes the bytes
+// immediately; finish() writes the footer. The Thrift metadata is written
+// by a small compact-protocol writer in parquet_writer.cpp — no Arrow or
+// Thrift library is needed.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "arrow_ipc.h"
+
+/** ParquetColumnChunk — One encoded column of a row group. */
+struct ParquetColumnChunk {
+    std::vector<uint8_t> bytes;             // dictionary page (if any), then data pages
+    int64_t              dictionaryPage = -1;  // offset in `bytes`, -1 = none
+    int64_t              dataPage       = 0;   // offset in `bytes` of the first data page
+    std::vector<int32_t> encodings;         // Parquet Encoding values used
+    std::string          minValue, maxValue;   // PLAIN-encoded statistics
+    int64_t              distinctCount  = -1;  // -1 = not known
+};
+
+/** ParquetRowGroup — A row group encoded by ParquetWriter::encode. */
+struct ParquetRowGroup {
+    std::size_t                     rows = 0;
+    std::vector<ParquetColumnChunk> columns;
+};
+
+/**
+ * ParquetWriter — Parquet file of TxnRecord row groups on `out`. The header
+ * magic is written by the constructor, the footer by finish() (or the
+ * destructor).
+ */
+class ParquetWriter {
+public:
+    explicit ParquetWriter(std::ostream& out);
+    ~ParquetWriter();
+
+    ParquetWriter(const ParquetWriter&) = delete;
+    ParquetWriter& operator=(const ParquetWriter&) = delete;
+
+    /**
+     * encode — One row group of the batch's records, in pages of up to 64Ki
+     * rows. Thread-safe; call it from as many threads as there are row
+     * groups in flight.
+     */
+    static ParquetRowGroup encode(const TxnArrowBatch& batch);
+
+    /** append — Write `group` as the next row group (its bytes are released). */
+    void append(ParquetRowGroup&& group);
+
+    /** finish — Footer (FileMetaData) and flush; false if the stream failed. */
+    bool finish();
+
+    uint64_t    bytesWritten() const { return bytes_; }
+    std::size_t rowGroups() const    { return groups_.size(); }
+
+private:
+    /** Written row group: chunk metadata with file offsets, without the bytes. */
+    struct GroupMeta {
+        std::size_t rows = 0;
+        struct Chunk {
+            ParquetColumnChunk meta;     // bytes empty
+            int64_t            fileOffset = 0;
+            int64_t            size = 0;
+        };
+        std::vector<Chunk> chunks;
+    };
+
+    std::ostream&          out_;
+    uint64_t               bytes_    = 0;
+    bool                   finished_ = false;
+    std::vector<GroupMeta> groups_;
+};
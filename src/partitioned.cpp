@@ -0,0 +1,212 @@
+// partitioned.cpp — Multi-threaded, NUMA-aware streaming pipeline
+//
+// The export is cut into one contiguous chunk per worker thread. Threads are
+// assigned to nodes in contiguous blocks (NumaTopology::nodeForThread), so
+// each node owns one contiguous slice of the export. Every worker pins to a
+// core of its node, places its chunk there (numa_topology.h), and runs its
+// own PipelineWorker. Store totals never cross a node boundary until the
+// run ends: workers merge into their node's partial, and the node partials
+// are merged once into Pipeline::totals.
+
+#include "pipeline.h"
+
+#include <barrier>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <thread>
+
+namespace {
+
+/** NodePartial — Totals of every worker on one node; allocated on that node. */
+struct NodePartial {
+    std::mutex                   mutex;
+    std::unique_ptr<StoreTotals> totals;
+    std::size_t                  threads = 0;
+    uint64_t                     records = 0;
+};
+
+struct PartitionedRun {
+    double                   seconds = 0;
+    uint64_t                 records = 0;
+    std::vector<NodePartial> nodes;
+
+    explicit PartitionedRun(std::size_t n) : nodes(n) {}
+};
+
+const char* policyName(NumaPolicy p) {
+    return p == NumaPolicy::kLocal ? "local" : p == NumaPolicy::kInterleave ? "interleave" : "off";
+}
+
+/**
+ * partitionSource — The generated export, in interleaved pages when the
+ * policy asks for it (kLocal workers copy their own chunk instead).
+ */
+PageBuffer partitionSource(const StreamOptions& opts, const NumaTopology& topo) {
+    const std::vector<char> generated = generateExport(opts.records);
+    PageBuffer source(generated.size());
+    if (opts.numa == NumaPolicy::kInterleave && topo.nodes() > 1 && !source.interleave(topo))
+        std::cerr << "mbind(MPOL_INTERLEAVE) refused; pages follow first touch\n";
+    std::memcpy(source.data(), generated.data(), generated.size());
+    return source;
+}
+
+/**
+ * runWorkers — One pass (or, with --follow, passes until stopped) of
+ * `threads` workers over `source`. The timed region starts once every
+ * worker has pinned and placed its chunk.
+ */
+PartitionedRun runWorkers(Pipeline& pipeline, const NumaTopology& topo, const PageBuffer& source,
+                          std::size_t threads, StageProfiler* profiler) {
+    const StreamOptions& opts = pipeline.opts;
+    const std::size_t records = opts.records;
+    PartitionedRun run(topo.nodes());
+    std::barrier start(static_cast<std::ptrdiff_t>(threads + 1));
+
+    auto body = [&](std::size_t t) {
+        const std::size_t nodeIdx = topo.nodeForThread(t, threads);
+        const NumaNode& node = topo.node(nodeIdx);
+        if (opts.numa != NumaPolicy::kOff) {
+            const std::size_t firstOnNode = (nodeIdx * threads + topo.nodes() - 1) / topo.nodes();
+            pinThreadToCpu(node.cpus[(t - firstOnNode) % node.cpus.size()]);
+        }
+
+        const std::size_t begin = t * records / threads, end = (t + 1) * records / threads;
+        const std::size_t bytes = (end - begin) * sizeof(TxnRecord);
+        const char* chunk = source.data() + begin * sizeof(TxnRecord);
+        PageBuffer local;
+        if (opts.numa == NumaPolicy::kLocal && bytes > 0) {
+            local = PageBuffer(bytes);               // first touch from the pinned thread
+            std::memcpy(local.data(), chunk, bytes);
+            chunk = local.data();
+        }
+        PipelineWorker worker(pipeline, t == 0 ? profiler : nullptr);
+        start.arrive_and_wait();
+
+        uint64_t processed = 0;
+        do {
+            for (std::size_t off = 0; off < end - begin; off += opts.batch) {
+                if (g_stopRequested.load(std::memory_order_relaxed)) break;
+                const std::size_t n = std::min(opts.batch, end - begin - off);
+                worker.process(chunk + off * sizeof(TxnRecord), n, pipeline.clock.now());
+                processed += n;
+            }
+        } while (opts.follow && !g_stopRequested.load(std::memory_order_relaxed));
+
+        NodePartial& partial = run.nodes[nodeIdx];
+        std::lock_guard<std::mutex> lock(partial.mutex);
+        if (!partial.totals) partial.totals = std::make_unique<StoreTotals>();
+        partial.totals->merge(worker.totals);
+        partial.threads += 1;
+        partial.records += processed;
+    };
+
+    std::vector<std::thread> workers;
+    workers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t)
+        workers.emplace_back(body, t);
+    start.arrive_and_wait();
+    const uint64_t t0 = pipeline.clock.now();
+    for (auto& w : workers) w.join();
+    run.seconds = static_cast<double>(pipeline.clock.toNs(pipeline.clock.now() - t0)) / 1e9;
+
+    for (auto& partial : run.nodes) {
+        if (partial.totals) pipeline.mergeTotals(*partial.totals);
+        run.records += partial.records;
+    }
+    return run;
+}
+
+double mrecPerSecond(const PartitionedRun& run) {
+    return run.seconds > 0 ? static_cast<double>(run.records) / run.seconds / 1e6 : 0.0;
+}
+
+}  // namespace
+
+int runPartitioned(const StreamOptions& opts) {
+    Pipeline pipeline(opts);
+    if (!pipeline.startMetricsServer())
+        return 1;
+    installSignalHandlers();
+
+    std::unique_ptr<StageProfiler> profiler;
+    if (!opts.tracePath.empty())
+        profiler = std::make_unique<StageProfiler>(
+            std::vector<std::string>{"read", "decode", "wait", "validate", "sink"}, 1u << 20);
+
+    const NumaTopology topo = NumaTopology::detect();
+    const PageBuffer source = partitionSource(opts, topo);
+    const PartitionedRun run = runWorkers(pipeline, topo, source, opts.threads, profiler.get());
+
+    pipeline.printSummary("Modernized x86 Partitioned Pipeline");
+    std::cout << "Threads    : " << opts.threads << " on " << topo.nodes()
+              << " NUMA node(s), placement " << policyName(opts.numa) << "\n";
+    for (std::size_t i = 0; i < run.nodes.size(); ++i)
+        std::cout << "  node " << topo.node(i).id << "   : " << run.nodes[i].threads
+                  << " threads, " << run.nodes[i].records << " records\n";
+    std::cout << "Throughput : " << std::setprecision(1) << mrecPerSecond(run) << " Mrec/s\n";
+
+    pipeline.latency.dump(std::cerr);
+    if (profiler) {
+        profiler->report(std::cerr, pipeline.clock);
+        if (!profiler->writeChromeTrace(opts.tracePath, pipeline.clock)) {
+            std::cerr << "cannot write " << opts.tracePath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * runScaling — Same export at 1 thread, one node's worth of threads, and
+ * every thread (opts.threads, or every usable CPU when not given).
+ *
+ * The first rows stay on the first node. efficiency = throughput(n) /
+ * (n × throughput(1)); "past one socket" compares all nodes against node
+ * count × the largest single-node run, which is where remote-memory traffic
+ * shows up.
+ */
+int runScaling(const StreamOptions& opts) {
+    const NumaTopology topo = NumaTopology::detect();
+    StreamOptions o = opts;
+    o.follow  = false;
+    o.records = opts.records ? opts.records : std::size_t{1} << 24;
+    const PageBuffer source = partitionSource(o, topo);
+
+    const std::size_t all     = opts.threads > 1 ? opts.threads : topo.cpus();
+    const std::size_t perNode = std::max<std::size_t>(1, all / topo.nodes());
+    const NumaTopology oneNode = topo.firstNode();
+    struct Step { std::size_t threads; const NumaTopology* topo; };
+    std::vector<Step> steps{{1, &oneNode}};
+    if (perNode > 1 && perNode < all) steps.push_back({perNode, &oneNode});
+    if (all > 1) steps.push_back({all, &topo});
+
+    std::cout << "=== Scaling: " << o.records << " records, " << topo.nodes()
+              << " NUMA node(s), placement " << policyName(opts.numa) << " ===\n\n"
+              << std::left << std::setw(10) << "threads" << std::right << std::setw(7) << "nodes"
+              << std::setw(12) << "Mrec/s" << std::setw(10) << "speedup"
+              << std::setw(12) << "efficiency" << "\n"
+              << std::fixed << std::setprecision(1);
+
+    double base = 0, singleNode = 0, allNodes = 0;
+    for (const Step& step : steps) {
+        o.threads = step.threads;
+        Pipeline pipeline(o);
+        const double rate = mrecPerSecond(runWorkers(pipeline, *step.topo, source, step.threads, nullptr));
+        if (step.threads == 1) base = rate;
+        if (step.topo == &oneNode) singleNode = rate;
+        else allNodes = rate;
+        const double speedup = base > 0 ? rate / base : 0.0;
+        std::cout << std::left << std::setw(10) << step.threads << std::right
+                  << std::setw(7) << step.topo->nodes()
+                  << std::setw(12) << rate << std::setw(9) << speedup << "x"
+                  << std::setw(11) << 100.0 * speedup / static_cast<double>(step.threads) << "%\n";
+    }
+    if (topo.nodes() > 1 && singleNode > 0 && allNodes > 0)
+        std::cout << "\nPast one socket : " << std::setprecision(1)
+                  << 100.0 * allNodes / (singleNode * static_cast<double>(topo.nodes()))
+                  << "% efficiency (" << all << " threads on " << topo.nodes()
+                  << " nodes vs " << topo.nodes() << " x " << steps[steps.size() - 2].threads
+                  << " on one)\n";
+    return 0;
+}
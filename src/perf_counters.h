@@ -0,0 +1,182 @@
+// perf_counters.h — In-process hardware counters via perf_event_open (Linux)
+//
+// Opens one counter GROUP per thread — cycles (leader), instructions, LLC
+// misses and dTLB misses — so all four are scheduled onto the PMU together
+// and their ratios are consistent even when the kernel has to multiplex.
+// Counting is user-space only (exclude_kernel), which works at the default
+// perf_event_paranoid level of 2 without an external `perf` session.
+//
+// Usage:
+//   PerfCounterGroup perf;                  // per thread; check perf.ok()
+//   PerfStageStats   stats({"decode", "sink"});
+//   auto start = perf.read();
+//   ... decode ...
+//   stats.add(0, perf.read() - start, recordsInBatch);
+//   stats.report(std::cerr);
+
+#pragma once
+
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/**
+ * PerfSample — One reading of the counter group, scaled for multiplexing.
+ */
+struct PerfSample {
+    uint64_t cycles       = 0;
+    uint64_t instructions = 0;
+    uint64_t llcMisses    = 0;
+    uint64_t dtlbMisses   = 0;
+
+    PerfSample operator-(const PerfSample& o) const {
+        return {cycles - o.cycles, instructions - o.instructions,
+                llcMisses - o.llcMisses, dtlbMisses - o.dtlbMisses};
+    }
+    PerfSample& operator+=(const PerfSample& o) {
+        cycles += o.cycles; instructions += o.instructions;
+        llcMisses += o.llcMisses; dtlbMisses += o.dtlbMisses;
+        return *this;
+    }
+};
+
+/**
+ * PerfCounterGroup — Grouped counters for the CALLING thread. Construct it on
+ * the thread being measured; on non-Linux hosts or when the PMU is not
+ * available (containers, some VMs), ok() is false and read() returns zeros.
+ */
+class PerfCounterGroup {
+public:
+    PerfCounterGroup() {
+#if defined(__linux__)
+        static constexpr uint64_t kCacheMissRead =
+            (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        const std::pair<uint32_t, uint64_t> events[kEvents] = {
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+            {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_LL   | kCacheMissRead},
+            {PERF_TYPE_HW_CACHE, PERF_COUNT_HW_CACHE_DTLB | kCacheMissRead}};
+
+        for (int i = 0; i < kEvents; ++i) {
+            perf_event_attr attr{};
+            attr.size           = sizeof(attr);
+            attr.type           = events[i].first;
+            attr.config         = events[i].second;
+            attr.disabled       = i == 0;   // the leader starts the whole group
+            attr.exclude_kernel = 1;
+            attr.exclude_hv     = 1;
+            attr.read_format    = PERF_FORMAT_GROUP
+                                | PERF_FORMAT_TOTAL_TIME_ENABLED
+                                | PERF_FORMAT_TOTAL_TIME_RUNNING;
+            const long fd = ::syscall(SYS_perf_event_open, &attr, 0, -1,
+                                      i == 0 ? -1 : fds_[0], 0);
+            if (fd < 0) {
+                error_ = std::strerror(errno);
+                close();
+                return;
+            }
+            fds_[i] = static_cast<int>(fd);
+        }
+        ::ioctl(fds_[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+        ::ioctl(fds_[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+#else
+        error_ = "perf_event_open is Linux-only";
+#endif
+    }
+
+    ~PerfCounterGroup() { close(); }
+
+    PerfCounterGroup(const PerfCounterGroup&) = delete;
+    PerfCounterGroup& operator=(const PerfCounterGroup&) = delete;
+
+    bool ok() const { return fds_[0] >= 0; }
+    const std::string& error() const { return error_; }
+
+    /** read — Current cumulative counts (one read() syscall for the group). */
+    PerfSample read() const {
+        PerfSample s;
+#if defined(__linux__)
+        if (!ok()) return s;
+        // Layout for PERF_FORMAT_GROUP: nr, time_enabled, time_running, values[nr]
+        uint64_t buf[3 + kEvents] = {};
+        if (::read(fds_[0], buf, sizeof(buf)) != static_cast<ssize_t>(sizeof(buf)))
+            return s;
+        // Scale up if the group was multiplexed off the PMU part of the time.
+        const double scale = buf[2] ? static_cast<double>(buf[1]) / static_cast<double>(buf[2]) : 1.0;
+        auto v = [&](int i) { return static_cast<uint64_t>(static_cast<double>(buf[3 + i]) * scale); };
+        s = {v(0), v(1), v(2), v(3)};
+#endif
+        return s;
+    }
+
+private:
+    static constexpr int kEvents = 4;
+
+    void close() {
+#if defined(__linux__)
+        for (int& fd : fds_)
+            if (fd >= 0) { ::close(fd); fd = -1; }
+#endif
+    }
+
+    int fds_[kEvents] = {-1, -1, -1, -1};
+    std::string error_;
+};
+
+/**
+ * PerfStageStats — Accumulated counter deltas per named stage, reported as
+ * per-record ratios.
+ */
+class PerfStageStats {
+public:
+    explicit PerfStageStats(std::vector<std::string> stages)
+        : stages_(std::move(stages)), totals_(stages_.size()), records_(stages_.size(), 0) {}
+
+    void add(std::size_t stage, const PerfSample& delta, uint64_t records) {
+        totals_[stage] += delta;
+        records_[stage] += records;
+    }
+
+    /** report — cycles, instructions, IPC, LLC and dTLB misses per record. */
+    void report(std::ostream& os) const {
+        os << "=== Hardware counters (per record) ===\n"
+           << std::left  << std::setw(20) << "stage"
+           << std::right << std::setw(12) << "records"
+           << std::setw(12) << "cycles" << std::setw(12) << "instr"
+           << std::setw(8)  << "IPC"
+           << std::setw(12) << "LLC-miss" << std::setw(12) << "dTLB-miss" << "\n";
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+        os << std::fixed << std::setprecision(2);
+        for (std::size_t s = 0; s < stages_.size(); ++s) {
+            const auto& t = totals_[s];
+            const double n = records_[s] ? static_cast<double>(records_[s]) : 1.0;
+            os << std::left  << std::setw(20) << stages_[s]
+               << std::right << std::setw(12) << records_[s]
+               << std::setw(12) << t.cycles / n
+               << std::setw(12) << t.instructions / n
+               << std::setw(8)  << (t.cycles ? static_cast<double>(t.instructions) / static_cast<double>(t.cycles) : 0.0)
+               << std::setw(12) << t.llcMisses / n
+               << std::setw(12) << t.dtlbMisses / n << "\n";
+        }
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+private:
+    std::vector<std::string> stages_;
+    std::vector<PerfSample>  totals_;
+    std::vector<uint64_t>    records_;
+};
@@ -0,0 +1,1140 @@
+// pipeline.cpp — Pipeline setup, signal handling, and the in-process run modes
+//
+// runStream replays the synthetic export (optionally forever, with --follow);
+// runMultiStream and runVariableStream do the same for multi-record-type and
+// variable-length (RDW) exports, runSchemaStream for runtime-defined layouts;
+// runArrowStream, runParquetStream, runTextStream, runBinaryStream and
+// runStoreFiles write the decoded export as Arrow, Parquet, CSV/NDJSON, raw
+// records and per-store files, of the generated export or of --input;
+// runFileScan runs a real export file through a worker and runWriteExport
+// writes one;
+// runTraining is the PGO workload. The TCP transport is in ingest_server.cpp.
+
+#include "pipeline.h"
+
+#include <cerrno>
+#include <cmath>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <fstream>
+#include <iostream>
+#include <thread>
+#include <unordered_set>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "arrow_ipc.h"
+#include "binary_writer.h"
+#include "multi_record.h"
+#include "parquet_writer.h"
+#include "rdw_framing.h"
+#include "record_schema.h"
+#include "text_format.h"
+#include "uring_writer.h"
+
+/**
+ * openPerf — Hardware counters for the calling thread, or nullptr (with a
+ * note on stderr) when disabled or unavailable.
+ */
+std::unique_ptr<PerfCounterGroup> openPerf(const StreamOptions& opts) {
+    if (!opts.perf) return nullptr;
+    auto perf = std::make_unique<PerfCounterGroup>();
+    if (!perf->ok()) {
+        std::cerr << "perf counters unavailable: " << perf->error() << "\n";
+        return nullptr;
+    }
+    return perf;
+}
+
+std::atomic<bool> g_stopRequested{false};
+std::atomic<bool> g_dumpRequested{false};
+
+extern "C" void onStopSignal(int) { g_stopRequested.store(true, std::memory_order_relaxed); }
+extern "C" void onDumpSignal(int) { g_dumpRequested.store(true, std::memory_order_relaxed); }
+
+void installSignalHandlers() {
+    std::signal(SIGINT,  onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+#ifdef SIGUSR1
+    std::signal(SIGUSR1, onDumpSignal);
+#endif
+}
+
+bool Pipeline::startMetricsServer() {
+    if (opts.metricsPort == 0) return true;
+    server = std::make_unique<MetricsServer>(static_cast<uint16_t>(opts.metricsPort),
+                                             [this] { return metrics.renderPrometheus(); });
+    if (server->ok()) return true;
+    std::cerr << "cannot listen on 127.0.0.1:" << opts.metricsPort << "\n";
+    return false;
+}
+
+void Pipeline::printSummary(const char* title) const {
+    uint64_t amountCents = 0;
+    std::size_t stores = 0;
+    for (std::size_t s = 0; s < totals.txns.size(); ++s) {
+        amountCents += totals.amountCents[s];
+        stores += totals.txns[s] != 0;
+    }
+    std::cout << "=== " << title << " ===\n\n";
+    std::cout << "Records    : " << metrics.total(kRecords) << "\n";
+    std::cout << "Rejected   : " << metrics.total(kValidationRejects) << "\n";
+    std::cout << "Stores     : " << stores << "\n";
+    std::cout << "Amount ($) : " << std::fixed << std::setprecision(2)
+              << amountCents / 100.0 << "\n";
+}
+
+int runStream(const StreamOptions& opts) {
+    if (!opts.exportPath.empty())
+        return runWriteExport(opts);
+    if (!opts.schemaPath.empty())
+        return runSchemaStream(opts);
+    if (!opts.arrowPath.empty())
+        return runArrowStream(opts);
+    if (!opts.parquetPath.empty())
+        return runParquetStream(opts);
+    if (!opts.csvPath.empty() || !opts.ndjsonPath.empty())
+        return runTextStream(opts);
+    if (!opts.binaryPath.empty())
+        return runBinaryStream(opts);
+    if (!opts.partitionDir.empty())
+        return runStoreFiles(opts);
+    if (!opts.inputPath.empty())
+        return runFileScan(opts);
+    if (!opts.recordTypes.empty())
+        return runMultiStream(opts);
+    if (!opts.rdw.empty())
+        return runVariableStream(opts);
+    if (opts.scaling)
+        return runScaling(opts);
+    if (opts.threads > 1)
+        return runPartitioned(opts);
+
+    Pipeline pipeline(opts);
+    if (!pipeline.startMetricsServer())
+        return 1;
+    installSignalHandlers();
+
+    std::unique_ptr<StageProfiler> profiler;
+    if (!opts.tracePath.empty())
+        profiler = std::make_unique<StageProfiler>(
+            std::vector<std::string>{"read", "decode", "wait", "validate", "sink"}, 1u << 20);
+    PipelineWorker worker(pipeline, profiler.get());
+
+    const std::vector<char> source = generateExport(opts.records);
+    std::vector<char> rawBatch(opts.batch * sizeof(TxnRecord));
+
+    std::size_t processed = 0;
+    std::size_t cursor = 0;        // record offset into the source export
+    while ((opts.follow || processed < opts.records)
+           && !g_stopRequested.load(std::memory_order_relaxed)) {
+        if (cursor == opts.records) cursor = 0;
+        const std::size_t n = std::min(opts.batch, opts.records - cursor);
+
+        const uint64_t tRead = pipeline.clock.now();
+        std::memcpy(rawBatch.data(), source.data() + cursor * sizeof(TxnRecord),
+                    n * sizeof(TxnRecord));
+        worker.process(rawBatch.data(), n, tRead);
+        processed += n;
+        cursor    += n;
+
+        if (g_dumpRequested.exchange(false, std::memory_order_relaxed))
+            pipeline.latency.dump(std::cerr);
+    }
+
+    pipeline.mergeTotals(worker.totals);
+    pipeline.printSummary("Modernized x86 Streaming Pipeline");
+    pipeline.latency.dump(std::cerr);
+    worker.reportPerf(std::cerr);
+    if (profiler) {
+        profiler->report(std::cerr, pipeline.clock);
+        if (!profiler->writeChromeTrace(opts.tracePath, pipeline.clock)) {
+            std::cerr << "cannot write " << opts.tracePath << "\n";
+            return 1;
+        }
+    }
+    return 0;
+}
+
+namespace {
+
+uint64_t totalAmountCents(const StoreTotals& totals) {
+    uint64_t sum = 0;
+    for (uint64_t cents : totals.amountCents) sum += cents;
+    return sum;
+}
+
+}  // namespace
+
+/**
+ * runMultiStream — runStream over a header / txn / void / trailer export.
+ *
+ * A batch is accounted in record order, cut at each header and trailer
+ * (SplitBatch::marks): the transactions of a segment go through the worker
+ * in one decodeBatch over their compacted run, then its voids are applied,
+ * then the header or trailer that ends it. Each trailer is checked against
+ * the records, transactions and net amount seen since the last header.
+ *
+ * A void is only reversed if it can match an accepted transaction: not one
+ * validation rejected since the header (rejects are rare, so their ids are
+ * what is kept), and not more than its store has taken in. Anything else
+ * would underflow the totals; it counts as a validation reject instead.
+ */
+int runMultiStream(const StreamOptions& opts) {
+    RecordLayout layout;
+    std::string error;
+    if (!parseRecordLayout(opts.recordTypes, layout, error)) {
+        std::cerr << "--record-types: " << error << "\n";
+        return 2;
+    }
+    Pipeline pipeline(opts);
+    if (!pipeline.startMetricsServer())
+        return 1;
+    installSignalHandlers();
+
+    PipelineWorker worker(pipeline);
+    const RecordDispatcher dispatcher(layout);
+    const std::vector<char> source = generateMultiExport(opts.records, layout);
+    const std::size_t total = source.size() / layout.length;
+    SplitBatch split;
+
+    uint64_t kinds[kRecordKinds] = {};
+    uint64_t sinceHeader = 0, txnsSinceHeader = 0, amountAtHeader = 0, badTrailers = 0, unmatchedVoids = 0;
+    std::unordered_set<uint32_t> rejectedIds;   // since the last header
+    std::size_t processed = 0, cursor = 0;
+    while ((opts.follow || processed < total) && !g_stopRequested.load(std::memory_order_relaxed)) {
+        if (cursor == total) cursor = 0;
+        const std::size_t n = std::min(opts.batch, total - cursor);
+
+        const uint64_t tRead = pipeline.clock.now();
+        dispatcher.split(source.data() + cursor * layout.length, n, split);
+        std::size_t record = 0, txn = 0, voids = 0, trailer = 0, unmatched = 0;
+        // Segments end at each mark, and the last one at the end of the batch
+        for (std::size_t m = 0; m <= split.marks.size(); ++m) {
+            const SplitBatch::Mark end = m < split.marks.size()
+                ? split.marks[m] : SplitBatch::Mark{kRecordUnknown, n, split.txns, split.voids.size()};
+            const std::size_t run = end.txns - txn;
+            if (run && worker.process(split.txnRaw.data() + txn * sizeof(TxnRecord), run, tRead) < run) {
+                const TxnRecord* decoded = worker.decoded();
+                for (std::size_t i = 0; i < run; ++i)
+                    if (!validateTxn(decoded[i])) rejectedIds.insert(decoded[i].txnId);
+            }
+            for (; voids < end.voids; ++voids) {
+                const VoidRecord& v = split.voids[voids];
+                uint64_t& storeTxns  = worker.totals.txns[v.storeNumber];
+                uint64_t& storeCents = worker.totals.amountCents[v.storeNumber];
+                if (storeTxns == 0 || storeCents < v.amountCents || rejectedIds.count(v.txnId)) {
+                    ++unmatched;
+                    continue;
+                }
+                --storeTxns;
+                storeCents -= v.amountCents;
+            }
+            sinceHeader     += end.record - record;
+            txnsSinceHeader += end.txns - txn;
+            record = end.record + 1;
+            txn    = end.txns;
+
+            if (end.kind == kRecordHeader) {
+                sinceHeader     = 1;   // the header itself
+                txnsSinceHeader = 0;
+                amountAtHeader  = totalAmountCents(worker.totals);
+                rejectedIds.clear();
+            } else if (end.kind == kRecordTrailer) {
+                const ExportTrailer& t = split.trailers[trailer++];
+                ++sinceHeader;         // the trailer itself
+                const uint64_t net = totalAmountCents(worker.totals) - amountAtHeader;
+                if (t.recordCount != sinceHeader || t.txnCount != txnsSinceHeader
+                    || t.netAmountCents != net) {
+                    ++badTrailers;
+                    std::cerr << "trailer mismatch: records " << sinceHeader << "/" << t.recordCount
+                              << ", txns " << txnsSinceHeader << "/" << t.txnCount
+                              << ", net cents " << net << "/" << t.netAmountCents << "\n";
+                }
+            }
+        }
+
+        if (unmatched) worker.countRejects(unmatched);
+        unmatchedVoids += unmatched;
+        kinds[kRecordHeader]  += split.headers.size();
+        kinds[kRecordTxn]     += split.txns;
+        kinds[kRecordVoid]    += split.voids.size();
+        kinds[kRecordTrailer] += split.trailers.size();
+        kinds[kRecordUnknown] += split.unknown;
+        processed += n;
+        cursor    += n;
+
+        if (g_dumpRequested.exchange(false, std::memory_order_relaxed))
+            pipeline.latency.dump(std::cerr);
+    }
+
+    pipeline.mergeTotals(worker.totals);
+    pipeline.printSummary("Modernized x86 Multi-Record Pipeline");
+    std::cout << "Record mix : " << kinds[kRecordHeader] << " header, " << kinds[kRecordTxn]
+              << " txn, " << kinds[kRecordVoid] << " void, " << kinds[kRecordTrailer]
+              << " trailer, " << kinds[kRecordUnknown] << " unknown\n";
+    if (unmatchedVoids)
+        std::cout << "Voids      : " << unmatchedVoids << " unmatched (counted as rejected)\n";
+    std::cout << "Trailers   : " << (badTrailers ? "MISMATCH" : "ok") << "\n";
+    pipeline.latency.dump(std::cerr);
+    worker.reportPerf(std::cerr);
+    return badTrailers ? 1 : 0;
+}
+
+/**
+ * runVariableStream — Frame a variable-length export (opts.rdw) across
+ * opts.threads threads, then decode contiguous record ranges in parallel,
+ * gathering each batch's TxnRecords into one run for decodeBatch.
+ */
+int runVariableStream(const StreamOptions& opts) {
+    RdwFormat format;
+    if (!parseRdwFormat(opts.rdw, format)) {
+        std::cerr << "--rdw: expected rdw, 2 or 4\n";
+        return 2;
+    }
+    Pipeline pipeline(opts);
+    if (!pipeline.startMetricsServer())
+        return 1;
+    installSignalHandlers();
+
+    const std::vector<char> source = generateVariableExport(opts.records, format);
+    const std::size_t threads = std::max<std::size_t>(1, opts.threads);
+    std::vector<uint64_t> offsets;
+    std::string error;
+    const uint64_t tFrame = pipeline.clock.now();
+    if (!frameRecordsParallel(source.data(), source.size(), format, threads, offsets, error)) {
+        std::cerr << "framing failed: " << error << "\n";
+        return 1;
+    }
+    const double frameMs = static_cast<double>(pipeline.clock.toNs(pipeline.clock.now() - tFrame)) / 1e6;
+
+    auto body = [&](std::size_t t) {
+        PipelineWorker worker(pipeline);
+        std::vector<char> raw(opts.batch * sizeof(TxnRecord));
+        const std::size_t begin = t * offsets.size() / threads;
+        const std::size_t end   = (t + 1) * offsets.size() / threads;
+        do {
+            for (std::size_t i = begin; i < end; i += opts.batch) {
+                if (g_stopRequested.load(std::memory_order_relaxed)) break;
+                const std::size_t n = std::min(opts.batch, end - i);
+                const uint64_t tRead = pipeline.clock.now();
+                gatherTxns(source.data(), offsets.data() + i, n, format, raw.data());
+                worker.process(raw.data(), n, tRead);
+            }
+        } while (opts.follow && !g_stopRequested.load(std::memory_order_relaxed));
+        pipeline.mergeTotals(worker.totals);
+    };
+    std::vector<std::thread> workers;
+    for (std::size_t t = 1; t < threads; ++t) workers.emplace_back(body, t);
+    body(0);
+    for (auto& w : workers) w.join();
+
+    pipeline.printSummary("Modernized x86 Variable-Length Pipeline");
+    std::cout << "Framing    : " << offsets.size() << " records, " << source.size()
+              << " bytes in " << std::setprecision(1) << frameMs << " ms on " << threads
+              << " thread" << (threads == 1 ? "" : "s") << "\n";
+    pipeline.latency.dump(std::cerr);
+    return 0;
+}
+
+/**
+ * runSchemaStream — Decode an export in the opts.schemaPath layout: the
+ * records of opts.inputPath when given (read through ExportReader with the
+ * schema's record length, on one thread), else a generated export split
+ * across opts.threads threads, one decode plan shared by all of them.
+ *
+ * Rows are not validated or aggregated (the schema carries no meaning the
+ * sink could use); instead every integer field is summed and every text
+ * field's bytes are summed, so two plans for the same layout can be checked
+ * against each other.
+ */
+int runSchemaStream(const StreamOptions& opts) {
+    RecordSchema schema;
+    std::string error;
+    if (!loadSchema(opts.schemaPath, schema, error)) {
+        std::cerr << "--schema: " << error << "\n";
+        return 2;
+    }
+    const DecodePlan plan = DecodePlan::build(schema);
+    const std::size_t fields = schema.fields.size();
+    std::unique_ptr<ExportReader> reader;
+    if (!opts.inputPath.empty()) {
+        reader = std::make_unique<ExportReader>(opts.inputPath, opts.readMode, !opts.keepCache,
+                                                schema.recordLength);
+        if (!reader->ok()) {
+            std::cerr << reader->error() << "\n";
+            return 1;
+        }
+        if (!reader->note().empty()) std::cerr << reader->note() << "\n";
+    }
+    // The reader is sequential, so a file is decoded on one thread
+    const std::size_t threads = reader ? 1 : std::max<std::size_t>(1, opts.threads);
+    std::size_t records = opts.records ? opts.records : std::size_t{1} << 20;
+    const std::vector<char> source = reader ? std::vector<char>{} : generateSchemaRecords(schema, records);
+    installSignalHandlers();
+
+    std::vector<std::vector<uint64_t>> sums(threads, std::vector<uint64_t>(fields, 0));
+    std::vector<std::size_t> bad(threads, 0);
+    std::vector<uint64_t> decodeTicks(threads, 0);
+    std::vector<char> firstRows;
+    TscClock clock;
+    auto consume = [&](std::size_t t, const char* raw, std::size_t n, char* rows, bool first) {
+        const uint64_t t0 = clock.now();
+        bad[t] += plan.decode(raw, n, rows);
+        decodeTicks[t] += clock.now() - t0;
+        for (std::size_t r = 0; r < n; ++r) {
+            const char* row = rows + r * plan.rowBytes();
+            for (std::size_t f = 0; f < fields; ++f) {
+                const FieldType type = schema.fields[f].type;
+                if (type == FieldType::kChar || type == FieldType::kEbcdic) {
+                    for (unsigned char c : plan.text(row, f)) sums[t][f] += c;
+                } else {
+                    sums[t][f] += static_cast<uint64_t>(plan.integer(row, f));
+                }
+            }
+        }
+        if (first) firstRows.assign(rows, rows + std::min<std::size_t>(n, 3) * plan.rowBytes());
+    };
+    if (reader) {
+        std::vector<char> rows(plan.outputBytes(opts.batch));
+        const char* raw = nullptr;
+        records = 0;
+        while (!g_stopRequested.load(std::memory_order_relaxed)) {
+            const std::size_t n = reader->next(opts.batch, raw);
+            if (n == 0) break;
+            consume(0, raw, n, rows.data(), records == 0);
+            records += n;
+        }
+        if (!reader->ok()) {
+            std::cerr << opts.inputPath << ": " << reader->error() << "\n";
+            return 1;
+        }
+    } else {
+        auto body = [&](std::size_t t) {
+            std::vector<char> rows(plan.outputBytes(opts.batch));
+            const std::size_t begin = t * records / threads, end = (t + 1) * records / threads;
+            for (std::size_t i = begin; i < end && !g_stopRequested.load(std::memory_order_relaxed);
+                 i += opts.batch) {
+                const std::size_t n = std::min(opts.batch, end - i);
+                consume(t, source.data() + i * schema.recordLength, n, rows.data(), i == 0);
+            }
+        };
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < threads; ++t) workers.emplace_back(body, t);
+        body(0);
+        for (auto& w : workers) w.join();
+    }
+    // Decode time only (checksumming excluded), of the slowest thread
+    const double seconds =
+        static_cast<double>(clock.toNs(*std::max_element(decodeTicks.begin(), decodeTicks.end()))) / 1e9;
+
+    std::size_t badTotal = 0;
+    for (std::size_t t = 0; t < threads; ++t) badTotal += bad[t];
+    std::cout << "=== Runtime Schema: " << opts.schemaPath << " ===\n\n";
+    std::cout << "Plan       : " << plan.shape() << "\n";
+    if (reader)
+        std::cout << "Input      : " << opts.inputPath << ", " << reader->bytesRead() << " bytes, "
+                  << readModeName(reader->mode()) << "\n";
+    std::cout << "Records    : " << records << " x " << schema.recordLength << " B -> "
+              << plan.rowBytes() << " B rows\n";
+    std::cout << "Decode     : " << std::fixed << std::setprecision(2)
+              << static_cast<double>(records * schema.recordLength) / seconds / 1e9 << " GB/s on "
+              << threads << " thread" << (threads == 1 ? "" : "s") << "\n";
+    std::cout << "Bad fields : " << badTotal << "\n\n";
+    for (std::size_t r = 0; r * plan.rowBytes() < firstRows.size(); ++r) {
+        const char* row = firstRows.data() + r * plan.rowBytes();
+        std::cout << "Row " << r << "     :";
+        for (std::size_t f = 0; f < fields; ++f) {
+            const SchemaField& field = schema.fields[f];
+            std::cout << " " << field.name << "=";
+            if (field.type == FieldType::kChar || field.type == FieldType::kEbcdic) {
+                std::cout << '"' << plan.text(row, f) << '"';
+            } else if (field.scale == 0) {
+                std::cout << plan.integer(row, f);
+            } else {
+                std::cout << std::setprecision(static_cast<int>(field.scale))
+                          << static_cast<double>(plan.integer(row, f)) / std::pow(10.0, field.scale);
+            }
+        }
+        std::cout << "\n";
+    }
+    std::cout << "Checksums  :";
+    for (std::size_t f = 0; f < fields; ++f) {
+        uint64_t sum = 0;
+        for (std::size_t t = 0; t < threads; ++t) sum += sums[t][f];
+        std::cout << " " << schema.fields[f].name << "=" << std::hex << sum << std::dec;
+    }
+    std::cout << "\n";
+    return 0;
+}
+
+namespace {
+
+/**
+ * ExportSource — The TxnRecords a sink consumes: opts.inputPath read through
+ * ExportReader (with its eviction), or else opts.records generated ones.
+ * next() hands out up to `max` contiguous records, in place when the reader
+ * already holds that many together (always under mmap), otherwise copied
+ * into one wave buffer. `raw` stays valid until the next call.
+ */
+class ExportSource {
+public:
+    explicit ExportSource(const StreamOptions& opts) {
+        if (opts.inputPath.empty()) {
+            generated_ = generateExport(opts.records ? opts.records : std::size_t{1} << 20);
+            records_   = generated_.size() / sizeof(TxnRecord);
+            return;
+        }
+        reader_ = std::make_unique<ExportReader>(opts.inputPath, opts.readMode, !opts.keepCache);
+        if (!reader_->note().empty()) std::cerr << reader_->note() << "\n";
+        records_ = reader_->fileBytes() / sizeof(TxnRecord);
+    }
+
+    bool               ok() const      { return !reader_ || reader_->ok(); }
+    const std::string& error() const   { return reader_->error(); }
+    std::size_t        records() const { return records_; }
+
+    std::size_t next(std::size_t max, const char*& raw) {
+        if (!reader_) {
+            const std::size_t n = std::min(max, records_ - cursor_);
+            raw = generated_.data() + cursor_ * sizeof(TxnRecord);
+            cursor_ += n;
+            return n;
+        }
+        std::size_t got = reader_->next(max, raw);
+        if (got == 0 || got == max) return got;
+        wave_.resize(max * sizeof(TxnRecord));
+        std::memcpy(wave_.data(), raw, got * sizeof(TxnRecord));
+        while (got < max) {
+            const std::size_t n = reader_->next(max - got, raw);
+            if (n == 0) break;
+            std::memcpy(wave_.data() + got * sizeof(TxnRecord), raw, n * sizeof(TxnRecord));
+            got += n;
+        }
+        raw = wave_.data();
+        return got;
+    }
+
+private:
+    std::vector<char>             generated_;
+    std::unique_ptr<ExportReader> reader_;
+    std::vector<char>             wave_;
+    std::size_t                   records_ = 0;
+    std::size_t                   cursor_  = 0;   // generated records handed out
+};
+
+}  // namespace
+
+/**
+ * runArrowStream — Decode the export (ExportSource) into Arrow record
+ * batches of 64Ki rows (--batch is sized for the latency-tracked pipeline,
+ * and Arrow consumers prefer far larger batches) and stream them to
+ * opts.arrowPath. Decode and write are timed separately.
+ */
+int runArrowStream(const StreamOptions& opts) {
+    constexpr std::size_t kBatchRows = std::size_t{1} << 16;
+    ExportSource source(opts);
+    if (!source.ok()) {
+        std::cerr << source.error() << "\n";
+        return 1;
+    }
+    installSignalHandlers();
+
+    std::ofstream file(opts.arrowPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "cannot write " << opts.arrowPath << "\n";
+        return 1;
+    }
+    TscClock clock;
+    uint64_t decodeTicks = 0, writeTicks = 0;
+    std::size_t batches = 0, written = 0;
+    ArrowIpcWriter writer(file);
+    TxnArrowBatch batch(kBatchRows);
+    const char* raw = nullptr;
+    for (; !g_stopRequested.load(std::memory_order_relaxed); ++batches) {
+        const std::size_t n = source.next(kBatchRows, raw);
+        if (n == 0) break;
+        const uint64_t t0 = clock.now();
+        batch.decode(raw, n);
+        const uint64_t t1 = clock.now();
+        writer.write(batch);
+        writeTicks  += clock.now() - t1;
+        decodeTicks += t1 - t0;
+        written     += n;
+    }
+    if (!source.ok()) {
+        std::cerr << opts.inputPath << ": " << source.error() << "\n";
+        return 1;
+    }
+    const uint64_t t0 = clock.now();
+    const bool ok = writer.finish();
+    writeTicks += clock.now() - t0;
+    if (!ok) {
+        std::cerr << "write failed: " << opts.arrowPath << "\n";
+        return 1;
+    }
+
+    const auto seconds = [&](uint64_t ticks) { return static_cast<double>(clock.toNs(ticks)) / 1e9; };
+    std::cout << "=== Arrow IPC Stream: " << opts.arrowPath << " ===\n\n";
+    std::cout << "Records    : " << written << " in " << batches << " record batches\n";
+    std::cout << "Decode     : " << std::fixed << std::setprecision(2)
+              << static_cast<double>(written * sizeof(TxnRecord)) / seconds(decodeTicks) / 1e9
+              << " GB/s (decode + transpose into column buffers)\n";
+    std::cout << "Write      : " << static_cast<double>(writer.bytesWritten()) / seconds(writeTicks) / 1e9
+              << " GB/s, " << writer.bytesWritten() << " bytes\n";
+    return 0;
+}
+
+namespace {
+
+/** WaveTicks — Time spent producing chunks (in parallel) and emitting them (in order). */
+struct WaveTicks {
+    uint64_t produce = 0;
+    uint64_t emit    = 0;
+};
+
+/**
+ * runWaves — Take `source` `threads` chunks of `chunk` records at a time:
+ * produce(t, begin, n, raw) builds chunk t of the wave — records [begin,
+ * begin + n) of the export, at `raw` — on its own thread (t = 0 on the
+ * caller's), then emit(t) consumes the wave's chunks in order. Stops after
+ * the current wave on g_stopRequested; the caller checks source.ok().
+ */
+template <typename Produce, typename Emit>
+WaveTicks runWaves(const TscClock& clock, ExportSource& source, std::size_t chunk, std::size_t threads,
+                   Produce&& produce, Emit&& emit) {
+    WaveTicks ticks;
+    const char* raw = nullptr;
+    for (std::size_t first = 0, n = 0; !g_stopRequested.load(std::memory_order_relaxed); first += n) {
+        n = source.next(threads * chunk, raw);
+        if (n == 0) break;
+        const std::size_t inWave = (n + chunk - 1) / chunk;
+        auto body = [&](std::size_t t) {
+            const std::size_t offset = t * chunk;
+            produce(t, first + offset, std::min(chunk, n - offset), raw + offset * sizeof(TxnRecord));
+        };
+        const uint64_t t0 = clock.now();
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < inWave; ++t) workers.emplace_back(body, t);
+        body(0);
+        for (auto& w : workers) w.join();
+        const uint64_t t1 = clock.now();
+        for (std::size_t t = 0; t < inWave; ++t) emit(t);
+        ticks.emit    += clock.now() - t1;
+        ticks.produce += t1 - t0;
+    }
+    return ticks;
+}
+
+/**
+ * writeThroughUring — runWaves into UringFileWriter buffers at `path`:
+ * fill(t, begin, n, raw, out) renders chunk [begin, begin + n), read at
+ * `raw`, at `out` (room for `chunkBytes`) on producer thread t and returns
+ * its size; buffers are
+ * submitted in chunk order and written by the writer thread. Prints the
+ * summary under `title`.
+ */
+template <typename Fill>
+int writeThroughUring(const StreamOptions& opts, const std::string& path, const char* title,
+                      ExportSource& source, std::size_t chunk, std::size_t chunkBytes, Fill&& fill) {
+    const std::size_t threads = std::max<std::size_t>(1, opts.threads);
+    UringFileWriter::Options options;
+    options.bufferBytes  = chunkBytes;
+    options.buffers      = 2 * threads + 2;   // one filling and one in flight per thread, plus slack
+    options.durabilityMs = opts.durabilityMs;
+    options.direct       = opts.direct;
+    UringFileWriter out(path, options);
+    if (!out.ok()) {
+        std::cerr << out.error() << "\n";
+        return 1;
+    }
+
+    TscClock clock;
+    std::size_t written = 0;
+    std::vector<UringFileWriter::Buffer*> buffers(threads);
+    std::vector<std::size_t> rows(threads);
+    const WaveTicks ticks = runWaves(clock, source, chunk, threads,
+        [&](std::size_t t, std::size_t begin, std::size_t n, const char* raw) {
+            buffers[t] = out.acquire();
+            buffers[t]->size = fill(t, begin, n, raw, buffers[t]->data);
+            rows[t] = n;
+        },
+        [&](std::size_t t) {
+            out.submit(buffers[t]);
+            written += rows[t];
+        });
+    const uint64_t t0 = clock.now();
+    const bool ok = out.close();
+    const uint64_t drainTicks = clock.now() - t0;
+    if (!source.ok()) {
+        std::cerr << opts.inputPath << ": " << source.error() << "\n";
+        return 1;
+    }
+    if (!ok) {
+        std::cerr << "write failed: " << path << ": " << out.error() << "\n";
+        return 1;
+    }
+
+    const auto seconds = [&](uint64_t t) { return static_cast<double>(clock.toNs(t)) / 1e9; };
+    const double bytes = static_cast<double>(out.bytesWritten());
+    std::cout << "=== " << title << ": " << path << " ===\n\n";
+    std::cout << "Records    : " << written << " (" << out.bytesWritten() << " bytes)\n";
+    std::cout << "Produce    : " << std::fixed << std::setprecision(2)
+              << static_cast<double>(written) / seconds(ticks.produce) / 1e6 << " Mrec/s on " << threads
+              << " thread" << (threads == 1 ? "" : "s") << ", " << out.stalls()
+              << " waits for a free buffer\n";
+    std::cout << "Write      : " << bytes / seconds(ticks.produce + ticks.emit + drainTicks) / 1e9
+              << " GB/s end to end via " << out.engine() << (opts.direct ? " (O_DIRECT)" : "") << ", "
+              << out.writes() << " writes, " << seconds(drainTicks) * 1e3 << " ms to drain\n";
+    std::cout << "Durable    : " << out.durableBytes() << " bytes after " << out.syncs() << " fdatasync"
+              << (out.syncs() == 1 ? "" : "s");
+    if (opts.durabilityMs != 0) std::cout << " (group commit every " << opts.durabilityMs << " ms)";
+    std::cout << "\n";
+    return 0;
+}
+
+}  // namespace
+
+/**
+ * runParquetStream — Archive the export (ExportSource) as Parquet. Row
+ * groups are decoded and encoded opts.threads at a time, one per thread,
+ * then appended in order; each thread reuses one column buffer across its
+ * row groups.
+ */
+int runParquetStream(const StreamOptions& opts) {
+    const std::size_t threads = std::max<std::size_t>(1, opts.threads);
+    ExportSource source(opts);
+    if (!source.ok()) {
+        std::cerr << source.error() << "\n";
+        return 1;
+    }
+    const std::size_t rowGroup = std::max<std::size_t>(1, std::min(opts.rowGroup, source.records()));
+    installSignalHandlers();
+
+    std::ofstream file(opts.parquetPath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "cannot write " << opts.parquetPath << "\n";
+        return 1;
+    }
+    TscClock clock;
+    std::size_t written = 0;
+    ParquetWriter writer(file);
+    std::vector<std::unique_ptr<TxnArrowBatch>> batches(threads);
+    std::vector<ParquetRowGroup> encoded(threads);
+    const WaveTicks ticks = runWaves(clock, source, rowGroup, threads,
+        [&](std::size_t t, std::size_t, std::size_t n, const char* raw) {
+            if (!batches[t]) batches[t] = std::make_unique<TxnArrowBatch>(rowGroup);
+            batches[t]->decode(raw, n);
+            encoded[t] = ParquetWriter::encode(*batches[t]);
+        },
+        [&](std::size_t t) {
+            written += encoded[t].rows;
+            writer.append(std::move(encoded[t]));
+            encoded[t] = ParquetRowGroup{};
+        });
+    if (!source.ok()) {
+        std::cerr << opts.inputPath << ": " << source.error() << "\n";
+        return 1;
+    }
+    const uint64_t encodeTicks = ticks.produce;
+    uint64_t writeTicks = ticks.emit;
+    const uint64_t t0 = clock.now();
+    const bool ok = writer.finish();
+    writeTicks += clock.now() - t0;
+    if (!ok) {
+        std::cerr << "write failed: " << opts.parquetPath << "\n";
+        return 1;
+    }
+
+    const auto seconds = [&](uint64_t ticks) { return static_cast<double>(clock.toNs(ticks)) / 1e9; };
+    const double rawBytes = static_cast<double>(written * sizeof(TxnRecord));
+    std::cout << "=== Parquet Archive: " << opts.parquetPath << " ===\n\n";
+    std::cout << "Records    : " << written << " in " << writer.rowGroups() << " row groups of up to "
+              << rowGroup << "\n";
+    std::cout << "Encode     : " << std::fixed << std::setprecision(2)
+              << rawBytes / seconds(encodeTicks) / 1e9 << " GB/s of export on " << threads
+              << " thread" << (threads == 1 ? "" : "s") << " (decode + encode)\n";
+    std::cout << "Write      : " << static_cast<double>(writer.bytesWritten()) / seconds(writeTicks) / 1e9
+              << " GB/s\n";
+    std::cout << "Size       : " << writer.bytesWritten() << " bytes, "
+              << rawBytes / static_cast<double>(writer.bytesWritten()) << "x smaller than the export\n";
+    return 0;
+}
+
+/**
+ * runTextStream — Write the export (ExportSource) as CSV (opts.csvPath) or
+ * NDJSON (opts.ndjsonPath). Chunks of 64Ki records are decoded and
+ * formatted opts.threads at a time, each into its thread's own buffer, and
+ * written in order — the concatenation is the sequence of writes.
+ */
+int runTextStream(const StreamOptions& opts) {
+    constexpr std::size_t kChunk = std::size_t{1} << 16;
+    const TextFormat format = opts.csvPath.empty() ? TextFormat::kNdjson : TextFormat::kCsv;
+    const std::string& path = format == TextFormat::kCsv ? opts.csvPath : opts.ndjsonPath;
+    const std::size_t threads = std::max<std::size_t>(1, opts.threads);
+    ExportSource source(opts);
+    if (!source.ok()) {
+        std::cerr << source.error() << "\n";
+        return 1;
+    }
+    installSignalHandlers();
+
+    if (opts.uring) {
+        if (opts.direct) {
+            std::cerr << "--direct needs fixed-size chunks (--binary)\n";
+            return 1;
+        }
+        const std::string_view header = textHeader(format);
+        std::vector<std::vector<TxnRecord>> decoded(threads, std::vector<TxnRecord>(kChunk));
+        return writeThroughUring(opts, path, format == TextFormat::kCsv ? "CSV Output" : "NDJSON Output",
+                                 source, kChunk, header.size() + kChunk * maxRowBytes(format),
+            [&](std::size_t t, std::size_t begin, std::size_t n, const char* raw, char* out) {
+                char* p = out;
+                if (begin == 0) p = std::copy(header.begin(), header.end(), p);
+                decodeBatch(raw, n, decoded[t].data());
+                return static_cast<std::size_t>(formatRows(format, decoded[t].data(), n, p) - out);
+            });
+    }
+
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "cannot write " << path << "\n";
+        return 1;
+    }
+    file << textHeader(format);
+    TscClock clock;
+    std::size_t written = 0;
+    uint64_t textBytes = textHeader(format).size();
+    std::vector<std::vector<TxnRecord>> decoded(threads, std::vector<TxnRecord>(kChunk));
+    std::vector<std::string> text(threads);
+    std::vector<std::size_t> rows(threads);
+    const WaveTicks ticks = runWaves(clock, source, kChunk, threads,
+        [&](std::size_t t, std::size_t, std::size_t n, const char* raw) {
+            decodeBatch(raw, n, decoded[t].data());
+            text[t].clear();
+            formatRows(format, decoded[t].data(), n, text[t]);
+            rows[t] = n;
+        },
+        [&](std::size_t t) {
+            file.write(text[t].data(), static_cast<std::streamsize>(text[t].size()));
+            textBytes += text[t].size();
+            written += rows[t];
+        });
+    if (!source.ok()) {
+        std::cerr << opts.inputPath << ": " << source.error() << "\n";
+        return 1;
+    }
+    file.flush();
+    if (!file) {
+        std::cerr << "write failed: " << path << "\n";
+        return 1;
+    }
+
+    const auto seconds = [&](uint64_t t) { return static_cast<double>(clock.toNs(t)) / 1e9; };
+    std::cout << "=== " << (format == TextFormat::kCsv ? "CSV" : "NDJSON") << " Output: " << path
+              << " ===\n\n";
+    std::cout << "Records    : " << written << "\n";
+    std::cout << "Format     : " << std::fixed << std::setprecision(2)
+              << static_cast<double>(written) / seconds(ticks.produce) / 1e6 << " Mrec/s, "
+              << static_cast<double>(textBytes) / seconds(ticks.produce) / 1e9 << " GB/s of text on "
+              << threads << " thread" << (threads == 1 ? "" : "s") << " (decode + format)\n";
+    std::cout << "Write      : " << static_cast<double>(textBytes) / seconds(ticks.emit) / 1e9
+              << " GB/s, " << textBytes << " bytes\n";
+    return 0;
+}
+
+/**
+ * runBinaryStream — Write the export (ExportSource) as raw host-order
+ * TxnRecords. Chunks of 64Ki records are decoded opts.threads at a time
+ * into a ring of page-aligned slots, and each half of the ring goes out in
+ * one writev (vmsplice on a pipe) once full. A slot is rewritten only after
+ * the other half has been flushed behind it — the reuse lag the pipe is
+ * sized to.
+ */
+int runBinaryStream(const StreamOptions& opts) {
+    constexpr std::size_t kChunk = std::size_t{1} << 16;
+    constexpr std::size_t kSlotBytes = kChunk * sizeof(TxnRecord);
+    const std::size_t threads = std::max<std::size_t>(1, opts.threads);
+    const std::size_t half = threads * ((8 + threads - 1) / threads);   // slots per flush, at least 8
+    const bool toStdout = opts.binaryPath == "-";
+    std::ostream& report = toStdout ? std::cerr : std::cout;
+    ExportSource source(opts);
+    if (!source.ok()) {
+        std::cerr << source.error() << "\n";
+        return 1;
+    }
+    installSignalHandlers();
+
+    if (opts.uring) {
+        if (toStdout) {
+            std::cerr << "--uring writes a file at its offsets; stdout cannot be one\n";
+            return 1;
+        }
+        return writeThroughUring(opts, opts.binaryPath, "Binary Output", source, kChunk, kSlotBytes,
+            [&](std::size_t, std::size_t, std::size_t n, const char* raw, char* out) {
+                decodeBatch(raw, n, reinterpret_cast<TxnRecord*>(out));
+                return n * sizeof(TxnRecord);
+            });
+    }
+
+    const int fd = toStdout ? STDOUT_FILENO
+                            : ::open(opts.binaryPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "cannot write " << opts.binaryPath << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    PageBuffer ring(2 * half * kSlotBytes);
+    BinaryWriter writer(fd, half * kSlotBytes);
+    if (!ring.data() || !writer.ok()) {
+        std::cerr << "cannot write " << opts.binaryPath << ": "
+                  << (writer.ok() ? "out of memory" : writer.error()) << "\n";
+        if (!toStdout) ::close(fd);
+        return 1;
+    }
+
+    TscClock clock;
+    std::size_t written = 0;
+    std::vector<std::size_t> slotOf(threads), rows(threads);
+    const WaveTicks ticks = runWaves(clock, source, kChunk, threads,
+        [&](std::size_t t, std::size_t begin, std::size_t n, const char* raw) {
+            slotOf[t] = begin / kChunk % (2 * half);
+            rows[t] = n;
+            decodeBatch(raw, n,
+                        reinterpret_cast<TxnRecord*>(ring.data() + slotOf[t] * kSlotBytes));
+        },
+        [&](std::size_t t) {
+            writer.gather(ring.data() + slotOf[t] * kSlotBytes, rows[t] * sizeof(TxnRecord));
+            written += rows[t];
+            if (slotOf[t] % half == half - 1) writer.flush();
+        });
+    const uint64_t t0 = clock.now();
+    const bool ok = writer.flush();
+    const uint64_t writeTicks = ticks.emit + (clock.now() - t0);
+    if (!toStdout) ::close(fd);
+    if (!source.ok()) {
+        std::cerr << opts.inputPath << ": " << source.error() << "\n";
+        return 1;
+    }
+    if (!ok) {
+        std::cerr << "write failed: " << opts.binaryPath << ": " << writer.error() << "\n";
+        return 1;
+    }
+
+    const auto seconds = [&](uint64_t t) { return static_cast<double>(clock.toNs(t)) / 1e9; };
+    const double bytes = static_cast<double>(writer.bytesWritten());
+    report << "=== Binary Output: " << (toStdout ? "stdout" : opts.binaryPath) << " ===\n\n";
+    report << "Records    : " << written << " (" << writer.bytesWritten() << " bytes)\n";
+    report << "Decode     : " << std::fixed << std::setprecision(2) << bytes / seconds(ticks.produce) / 1e9
+           << " GB/s on " << threads << " thread" << (threads == 1 ? "" : "s") << "\n";
+    report << "Write      : " << bytes / seconds(writeTicks) / 1e9 << " GB/s, " << writer.syscalls()
+           << " " << writer.modeName() << " calls";
+    if (writer.mode() == BinaryWriter::Mode::kVmsplice)
+        report << ", pipe " << writer.pipeCapacity() / 1024 << " KiB";
+    report << "\n";
+    return 0;
+}
+
+/**
+ * runStoreFiles — Write the export (ExportSource) to one file per store.
+ * Chunks of 64Ki records are decoded and partitioned by store opts.threads
+ * at a time, each into its thread's own StorePartition, and the runs are
+ * appended in chunk order, so every file keeps the export's record order.
+ */
+int runStoreFiles(const StreamOptions& opts) {
+    constexpr std::size_t kChunk = std::size_t{1} << 16;
+    const std::size_t threads = std::max<std::size_t>(1, opts.threads);
+    ExportSource source(opts);
+    if (!source.ok()) {
+        std::cerr << source.error() << "\n";
+        return 1;
+    }
+    installSignalHandlers();
+
+    StoreFileWriter writer(opts.partitionDir, opts.partitionFormat, opts.openFiles);
+    if (!writer.ok()) {
+        std::cerr << writer.error() << "\n";
+        return 1;
+    }
+    TscClock clock;
+    std::size_t written = 0;
+    std::vector<std::vector<TxnRecord>> decoded(threads, std::vector<TxnRecord>(kChunk));
+    std::vector<StorePartition> parts(threads);
+    const WaveTicks ticks = runWaves(clock, source, kChunk, threads,
+        [&](std::size_t t, std::size_t, std::size_t n, const char* raw) {
+            decodeBatch(raw, n, decoded[t].data());
+            partitionByStore(decoded[t].data(), n, parts[t]);
+        },
+        [&](std::size_t t) {
+            writer.append(parts[t]);
+            written += parts[t].records.size();
+        });
+    if (!source.ok()) {
+        std::cerr << opts.inputPath << ": " << source.error() << "\n";
+        return 1;
+    }
+    const uint64_t t0 = clock.now();
+    const bool ok = writer.finish();
+    const uint64_t writeTicks = ticks.emit + (clock.now() - t0);
+    if (!ok) {
+        std::cerr << writer.error() << "\n";
+        return 1;
+    }
+
+    const auto seconds = [&](uint64_t t) { return static_cast<double>(clock.toNs(t)) / 1e9; };
+    const double bytes = static_cast<double>(writer.bytesWritten());
+    std::cout << "=== Store Files: " << opts.partitionDir << " ===\n\n";
+    std::cout << "Records    : " << written << " in " << writer.files() << " files\n";
+    std::cout << "Partition  : " << std::fixed << std::setprecision(2)
+              << static_cast<double>(written) / seconds(ticks.produce) / 1e6 << " Mrec/s on " << threads
+              << " thread" << (threads == 1 ? "" : "s") << " (decode + partition)\n";
+    std::cout << "Write      : " << bytes / seconds(writeTicks) / 1e9 << " GB/s, " << writer.writes()
+              << " writes of " << bytes / static_cast<double>(std::max<uint64_t>(1, writer.writes())) / 1024
+              << " KiB on average\n";
+    std::cout << "Files      : " << writer.opens() << " opens, " << writer.evictions()
+              << " closed early (at most " << std::max<std::size_t>(1, opts.openFiles) << " open)\n";
+    return 0;
+}
+
+/**
+ * runFileScan — Push every record of opts.inputPath through one worker.
+ * Batches are handed to the worker where the reader holds them (in the
+ * mapping, under mmap), so the only copy is the one the read mode makes.
+ */
+int runFileScan(const StreamOptions& opts) {
+    ExportReader reader(opts.inputPath, opts.readMode, !opts.keepCache);
+    if (!reader.ok()) {
+        std::cerr << reader.error() << "\n";
+        return 1;
+    }
+    if (!reader.note().empty()) std::cerr << reader.note() << "\n";
+
+    Pipeline pipeline(opts);
+    if (!pipeline.startMetricsServer())
+        return 1;
+    installSignalHandlers();
+    PipelineWorker worker(pipeline, nullptr);
+
+    const uint64_t t0 = pipeline.clock.now();
+    const char* raw = nullptr;
+    while (!g_stopRequested.load(std::memory_order_relaxed)) {
+        const uint64_t tRead = pipeline.clock.now();
+        const std::size_t n = reader.next(opts.batch, raw);
+        if (n == 0) break;
+        worker.process(raw, n, tRead);
+
+        if (g_dumpRequested.exchange(false, std::memory_order_relaxed))
+            pipeline.latency.dump(std::cerr);
+    }
+    const double seconds = static_cast<double>(pipeline.clock.toNs(pipeline.clock.now() - t0)) / 1e9;
+    if (!reader.ok()) {
+        std::cerr << opts.inputPath << ": " << reader.error() << "\n";
+        return 1;
+    }
+
+    pipeline.mergeTotals(worker.totals);
+    pipeline.printSummary("Export File Scan");
+    const int64_t resident = residentBytes(opts.inputPath);
+    std::cout << "Input      : " << reader.bytesRead() << " bytes, " << readModeName(reader.mode())
+              << ", " << std::fixed << std::setprecision(2)
+              << static_cast<double>(reader.bytesRead()) / std::max(seconds, 1e-9) / 1e9 << " GB/s\n";
+    std::cout << "Page cache : ";
+    if (reader.mode() == ReadMode::kDirect)
+        std::cout << "bypassed (O_DIRECT)";
+    else if (opts.keepCache)
+        std::cout << "kept";
+    else
+        std::cout << reader.evictedBytes() / (1024 * 1024) << " MiB given back behind the cursor";
+    if (resident >= 0) std::cout << ", " << resident / (1024 * 1024) << " MiB resident after the scan";
+    std::cout << "\n";
+    pipeline.latency.dump(std::cerr);
+    worker.reportPerf(std::cerr);
+    return 0;
+}
+
+/**
+ * runWriteExport — Write the generated export to opts.exportPath: TxnRecords,
+ * or records in the opts.schemaPath layout when one is given.
+ */
+int runWriteExport(const StreamOptions& opts) {
+    const std::size_t records = opts.records ? opts.records : std::size_t{1} << 20;
+    std::vector<char> source;
+    if (opts.schemaPath.empty()) {
+        source = generateExport(records);
+    } else {
+        RecordSchema schema;
+        std::string error;
+        if (!loadSchema(opts.schemaPath, schema, error)) {
+            std::cerr << "--schema: " << error << "\n";
+            return 2;
+        }
+        source = generateSchemaRecords(schema, records);
+    }
+    const int fd = ::open(opts.exportPath.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        std::cerr << "cannot write " << opts.exportPath << ": " << std::strerror(errno) << "\n";
+        return 1;
+    }
+    const char* p = source.data();
+    std::size_t left = source.size();
+    while (left > 0) {
+        const ssize_t n = ::write(fd, p, left);
+        if (n < 0 && errno == EINTR) continue;
+        if (n < 0) {
+            std::cerr << "write failed: " << opts.exportPath << ": " << std::strerror(errno) << "\n";
+            ::close(fd);
+            return 1;
+        }
+        p += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    ::close(fd);
+    std::cout << "Wrote " << records << " records (" << source.size() << " bytes) to " << opts.exportPath << "\n";
+    return 0;
+}
+
+// ---------------------------------------------------------------------------
+// PGO training workload
+//
+// `--train` is the representative run a profile-guided build records
+// (CMake: -DPOS_PGO=GENERATE, then `cmake --build . --target pgo-train`).
+// It covers every hot path in roughly production proportions: the streaming
+// worker (decode → validate → aggregate with sampling), then filter and
+// text formatting over the decoded batches. The export is generated, so the
+// profile — and with it the optimized binary — is reproducible anywhere.
+// ---------------------------------------------------------------------------
+
+int runTraining(const StreamOptions& opts) {
+    const std::size_t records = opts.records ? opts.records : std::size_t{1} << 22;
+    const std::size_t passes  = 3;
+
+    Pipeline pipeline(opts);
+    PipelineWorker worker(pipeline);
+    const std::vector<char> source = generateExport(records);
+    std::vector<TxnRecord> decoded(opts.batch), kept(opts.batch);
+    const TxnFilter filter{25'000, 75'000, 110, 139};
+    std::string text;
+    uint64_t keptTotal = 0, formattedBytes = 0;
+
+    for (std::size_t pass = 0; pass < passes; ++pass) {
+        for (std::size_t off = 0; off < records; off += opts.batch) {
+            const std::size_t n = std::min(opts.batch, records - off);
+            const char* raw = source.data() + off * sizeof(TxnRecord);
+            worker.process(raw, n, pipeline.clock.now());
+
+            decodeBatch(raw, n, decoded.data());
+            const std::size_t k = filterBatch(decoded.data(), n, filter, kept.data());
+            text.clear();
+            formatBatch(kept.data(), k, text);
+            keptTotal      += k;
+            formattedBytes += text.size();
+        }
+    }
+
+    pipeline.mergeTotals(worker.totals);
+    pipeline.printSummary("PGO Training Workload");
+    std::cout << "Filtered   : " << keptTotal << " kept\n";
+    std::cout << "Formatted  : " << formattedBytes << " bytes\n";
+    return 0;
+}
@@ -0,0 +1,369 @@
+// pipeline.h — Streaming decode → validate → sink pipeline (libpos)
+//
+// `--records N` pushes N synthetic Big-Endian records through the same
+// read → decode → sink flow a nightly export takes on the x86 host:
+//
+//   read      copy one batch of raw records out of the source buffer
+//   decode    memcpy + byte-swap the batch into host-order TxnRecords
+//   validate  reject records that cannot be genuine (see validateTxn)
+//   sink      aggregate amounts per store
+//
+// Every batch records its read-to-decode, decode-to-sink and end-to-end
+// latency; every Nth record additionally records its own end-to-end latency.
+// Percentiles are dumped on exit, on SIGUSR1, and on SIGINT/SIGTERM.
+// Timestamps come from the calibrated TSC (tsc_clock.h), not std::chrono.
+//
+// `--trace FILE` additionally keeps every sampled record's timestamps through
+// read, decode, wait (queued behind earlier records of its batch), validate
+// and sink, prints the per-stage breakdown, and writes a Chrome trace.
+//
+// `--metrics-port P` serves the same counters and histograms in Prometheus
+// text format on http://127.0.0.1:P/metrics; `--follow` replays the export
+// until SIGINT/SIGTERM so the process can run as a long-lived daemon.
+//
+// `--listen PORT` replaces the synthetic export with records streamed over
+// TCP by store controllers (framing in ingest_protocol.h); each connection
+// is a coroutine on one of `--threads` io_uring executors (uring_executor.h)
+// running the same decode → validate → sink stages.
+//
+// `--threads N` splits the export into N contiguous chunks, one per worker
+// thread, placed and pinned per NUMA node (`--numa local|interleave|off`,
+// see numa_topology.h); store totals merge per node, then once at the end.
+// `--scaling` runs it at 1 thread, one node's cores and all threads and
+// reports the speedup and the scaling efficiency past one socket.
+//
+// `--record-types SPEC` replays a multi-record export instead (header, txn,
+// void and trailer records; layout syntax in multi_record.h): txn payloads
+// are compacted into one run per batch, voids reverse their transaction, and
+// trailers are checked against the control totals.
+//
+// `--rdw rdw|2|4` replays a variable-length export: records are framed from
+// their Big-Endian length prefixes across `--threads` threads, then decoded
+// in parallel record ranges.
+//
+// `--schema FILE` decodes records of a layout described at run time (syntax
+// in record_schema.h) through a compiled DecodePlan across `--threads`
+// threads, and reports the plan, throughput and per-field checksums.
+//
+// `--arrow FILE` decodes the export straight into Arrow column buffers
+// (arrow_ipc.h) and writes them to FILE as an Arrow IPC stream.
+//
+// `--parquet FILE` archives the export as Parquet (parquet_writer.h), one
+// row group per `--row-group N` records, row groups encoded in parallel on
+// `--threads` threads and written in order.
+//
+// `--csv FILE` / `--ndjson FILE` write the decoded export as text rows
+// (text_format.h), formatted in parallel chunks and written in order.
+//
+// `--binary FILE` writes the decoded records as raw 16-byte host-order
+// TxnRecords (binary_writer.h): many batches per writev, or vmsplice when
+// FILE is a pipe. FILE `-` is stdout, and the summary then goes to stderr.
+//
+// `--partition-dir DIR` writes one file per store (store_partition.h):
+// batches radix-partitioned by store on `--threads` threads, appended in
+// order through per-store buffers, with at most `--open-files N` open.
+// `--partition-format raw|csv|ndjson` picks the file contents.
+//
+// `--uring` moves the --binary / --csv / --ndjson writes onto a writer
+// thread (uring_writer.h): producers fill pooled aligned buffers and the
+// writer keeps several writes in flight through io_uring.
+// `--durability-ms N` adds a group-commit fdatasync every N ms, and
+// `--direct` opens the output O_DIRECT (--binary only).
+//
+// `--input FILE` scans an export file instead of generating one
+// (export_reader.h), on one worker, with `--read-mode buffered|mmap|direct`.
+// Pages behind the cursor leave the page cache as the scan passes them
+// unless `--keep-cache` is given. `--write-export FILE` writes the
+// generated Big-Endian export, e.g. to scan it later.
+//
+// `--perf` brackets the decode and validate+sink regions (and processTxn in
+// the single-record demo) with grouped hardware counters and reports
+// cycles, instructions, LLC and dTLB misses per record.
+//
+// USDT probes (provider `pos`, see usdt.h) mark each stage boundary:
+//   batch__start(seq, records)       decode(seq, records)
+//   validate(seq, rejects)           validate__reject(txnId, store)
+//   sink__flush(seq, accepted)       batch__end(seq, records)
+//
+// Embedding: fill a StreamOptions and call runStream / runIngest, or build a
+// Pipeline and drive one PipelineWorker per thread with your own transport.
+// PipelineWorker::process is defined here so it inlines into the caller's
+// read loop; the batch kernels it calls are in txn_batch.cpp.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "export_reader.h"
+#include "latency_histogram.h"
+#include "metrics.h"
+#include "metrics_server.h"
+#include "numa_topology.h"
+#include "perf_counters.h"
+#include "stage_profiler.h"
+#include "store_partition.h"
+#include "tsc_clock.h"
+#include "txn_batch.h"
+#include "txn_record.h"
+#include "usdt.h"
+
+struct StreamOptions {
+    std::size_t records     = 0;     // 0 = single-record demo
+    std::size_t batch       = 1024;  // records per batch
+    std::size_t sampleEvery = 1024;  // per-record latency sampling interval
+    std::size_t metricsPort = 0;     // 0 = no Prometheus endpoint
+    std::size_t listenPort  = 0;     // 0 = no TCP ingest
+    bool        follow      = false; // replay the export until signalled
+    bool        perf        = false; // hardware counters per stage
+    bool        train       = false; // run the PGO training workload
+    std::string tracePath;           // Chrome trace of sampled records
+    std::size_t threads     = 1;     // >1 = partitioned, one chunk per thread
+    NumaPolicy  numa        = NumaPolicy::kLocal; // placement when partitioned
+    bool        scaling     = false; // report throughput at 1 / one node / all threads
+    std::string recordTypes;         // multi-record layout (multi_record.h); empty = TxnRecords only
+    std::string rdw;                 // variable-length prefix: rdw, 2 or 4 (rdw_framing.h)
+    std::string schemaPath;          // runtime record layout (record_schema.h)
+    std::string arrowPath;           // Arrow IPC stream output (arrow_ipc.h)
+    std::string parquetPath;         // Parquet output (parquet_writer.h)
+    std::size_t rowGroup    = std::size_t{1} << 20; // Parquet rows per row group
+    std::string csvPath;             // CSV output (text_format.h)
+    std::string ndjsonPath;          // NDJSON output (text_format.h)
+    std::string binaryPath;          // raw host-order TxnRecords (binary_writer.h); "-" = stdout
+    std::string partitionDir;        // one file per store (store_partition.h)
+    StoreFileFormat partitionFormat = StoreFileFormat::kRaw;
+    std::size_t openFiles   = 256;   // descriptors the per-store writer keeps open
+    bool        uring       = false; // output through UringFileWriter (uring_writer.h)
+    std::size_t durabilityMs = 0;    // group-commit interval with --uring; 0 = sync at close only
+    bool        direct      = false; // O_DIRECT output with --uring
+    std::string inputPath;           // scan this export file (export_reader.h)
+    ReadMode    readMode    = ReadMode::kBuffered;
+    bool        keepCache   = false; // --input: leave scanned pages in the page cache
+    std::string exportPath;          // write the generated Big-Endian export here
+};
+
+/**
+ * openPerf — Hardware counters for the calling thread, or nullptr (with a
+ * note on stderr) when disabled or unavailable.
+ */
+std::unique_ptr<PerfCounterGroup> openPerf(const StreamOptions& opts);
+
+enum LatencyStage : std::size_t {
+    kReadToDecode, kDecodeToSink, kBatchEndToEnd, kRecordEndToEnd
+};
+
+enum StreamCounter : std::size_t {
+    kRecords, kBytes, kBatches, kValidationRejects
+};
+
+/** Set by SIGINT/SIGTERM (or requestStop) and SIGUSR1; polled by the run loops. */
+extern std::atomic<bool> g_stopRequested;
+extern std::atomic<bool> g_dumpRequested;
+
+/** installSignalHandlers — SIGINT/SIGTERM stop the run loops, SIGUSR1 dumps latency. */
+void installSignalHandlers();
+
+/** requestStop — Ask runStream / runIngest to finish and print their summary. */
+inline void requestStop() { g_stopRequested.store(true, std::memory_order_relaxed); }
+
+/**
+ * Pipeline — State shared by every worker thread: the clock, the latency and
+ * counter registries, the Prometheus endpoint, and the merged store totals.
+ */
+struct Pipeline {
+    explicit Pipeline(const StreamOptions& o)
+        : opts(o),
+          latency({"read_to_decode", "decode_to_sink",
+                   "batch_end_to_end", "record_end_to_end"}),
+          metrics({{"pos_records_total",            "Records decoded"},
+                   {"pos_bytes_total",              "Raw Big-Endian bytes read"},
+                   {"pos_batches_total",            "Batches processed"},
+                   {"pos_validation_rejects_total", "Records rejected by validation"}}) {
+        metrics.setInfo("pos_decode_kernel_info", "kernel", decodeKernelName());
+        metrics.addLatency("pos_stage_latency_seconds", &latency);
+    }
+
+    /** startMetricsServer — Serve /metrics if requested; false if the port is unusable. */
+    bool startMetricsServer();
+
+    void mergeTotals(const StoreTotals& local) {
+        std::lock_guard<std::mutex> lock(totalsMutex);
+        totals.merge(local);
+    }
+
+    /** printSummary — Record counts and per-store aggregates on stdout. */
+    void printSummary(const char* title) const;
+
+    const StreamOptions& opts;
+    const TscClock       clock;
+    LatencyRegistry      latency;
+    MetricsRegistry      metrics;
+    std::unique_ptr<MetricsServer> server;
+    std::mutex           totalsMutex;
+    StoreTotals          totals;
+};
+
+/**
+ * PipelineWorker — One thread's decode → validate → sink stages, with its own
+ * histograms, counters, store totals and (with --perf) hardware counters.
+ * Construct it on the thread that will call process().
+ */
+class PipelineWorker {
+public:
+    explicit PipelineWorker(Pipeline& p, StageProfiler* profiler = nullptr)
+        : p_(p),
+          hist_(p.latency.attachThread()),
+          counters_(p.metrics.attachThread()),
+          perf_(openPerf(p.opts)),
+          perfStats_({"decode", "validate_sink"}),
+          profiler_(profiler),
+          batch_(p.opts.batch) {}
+
+    /**
+     * process — Decode, validate and sink `n` raw Big-Endian records (at most
+     * one batch) whose read started at tick `tRead`. Returns the number of
+     * records accepted by validation.
+     */
+    std::size_t process(const char* raw, std::size_t n, uint64_t tRead) {
+        enum PerfStage : std::size_t { kPerfDecode, kPerfValidateSink };
+        enum ProfileBoundary : std::size_t {
+            kAtRead, kAtDecode, kAtDecoded, kAtValidate, kAtSink, kAtDone, kBoundaries
+        };
+        const TscClock& clock = p_.clock;
+        POS_PROBE2(batch__start, batchSeq_, n);
+
+        const uint64_t tDecodeStart = clock.now();
+        PerfSample perfMark;
+        if (perf_) perfMark = perf_->read();
+        decodeBatch(raw, n, batch_.data());
+        if (perf_) {
+            const PerfSample now = perf_->read();
+            perfStats_.add(kPerfDecode, now - perfMark, n);
+            perfMark = now;
+        }
+        const uint64_t tDecoded = clock.now();
+        POS_PROBE2(decode, batchSeq_, n);
+
+        // Unsampled runs go through the vectorized aggregateBatch kernel; the
+        // sampled record between two runs is validated and sunk on its own so
+        // its stage boundaries can be timestamped.
+        std::size_t rejects = 0;
+        for (std::size_t i = 0; i < n; ++i) {
+            const std::size_t run = std::min(untilSample_, n - i);
+            rejects      += aggregateBatch(batch_.data() + i, run, totals);
+            untilSample_ -= run;
+            i            += run;
+            if (i == n) break;
+
+            const uint64_t tValidate = clock.now();
+            const bool valid = validateTxn(batch_[i]);
+            const uint64_t tSink = clock.now();
+            if (valid)
+                totals.add(batch_[i]);
+            else {
+                ++rejects;
+                POS_PROBE2(validate__reject, batch_[i].txnId, batch_[i].storeNumber);
+            }
+            untilSample_ = p_.opts.sampleEvery - 1;
+            const uint64_t tDone = clock.now();
+            hist_[kRecordEndToEnd].record(clock.toNs(tDone - tRead));
+            if (profiler_) {
+                const uint64_t b[kBoundaries] = {tRead, tDecodeStart, tDecoded,
+                                                 tValidate, tSink, tDone};
+                profiler_->sample(batch_[i].txnId, b);
+            }
+        }
+        POS_PROBE2(validate, batchSeq_, rejects);
+        POS_PROBE2(sink__flush, batchSeq_, n - rejects);
+        if (perf_) perfStats_.add(kPerfValidateSink, perf_->read() - perfMark, n);
+        const uint64_t tSunk = clock.now();
+
+        hist_[kReadToDecode].record(clock.toNs(tDecoded - tRead));
+        hist_[kDecodeToSink].record(clock.toNs(tSunk - tDecoded));
+        hist_[kBatchEndToEnd].record(clock.toNs(tSunk - tRead));
+        POS_PROBE2(batch__end, batchSeq_, n);
+        ++batchSeq_;
+
+        counters_->add(kRecords, n);
+        counters_->add(kBytes, n * sizeof(TxnRecord));
+        counters_->add(kBatches, 1);
+        counters_->add(kValidationRejects, rejects);
+        return n - rejects;
+    }
+
+    /** decoded — The records of the last process() call, in host order. */
+    const TxnRecord* decoded() const { return batch_.data(); }
+
+    /** countRejects — Records rejected outside process(), e.g. unmatched voids. */
+    void countRejects(std::size_t n) { counters_->add(kValidationRejects, n); }
+
+    /** reportPerf — Hardware counter ratios, if --perf was requested and available. */
+    void reportPerf(std::ostream& os) const {
+        if (perf_) perfStats_.report(os);
+    }
+
+    StoreTotals totals;
+
+private:
+    Pipeline&                         p_;
+    LatencyHistogram*                 hist_;
+    CounterBlock*                     counters_;
+    std::unique_ptr<PerfCounterGroup> perf_;
+    PerfStageStats                    perfStats_;
+    StageProfiler*                    profiler_;
+    std::vector<TxnRecord>            batch_;
+    uint64_t                          batchSeq_    = 0;
+    std::size_t                       untilSample_ = 0;  // records until the next sample
+};
+
+/** runStream — Push opts.records synthetic export records through the pipeline. */
+int runStream(const StreamOptions& opts);
+
+/** runMultiStream — runStream over a multi-record-type export (opts.recordTypes). */
+int runMultiStream(const StreamOptions& opts);
+
+/** runVariableStream — runStream over a variable-length export (opts.rdw). */
+int runVariableStream(const StreamOptions& opts);
+
+/** runSchemaStream — Decode opts.inputPath (or opts.records generated records) in the opts.schemaPath layout. */
+int runSchemaStream(const StreamOptions& opts);
+
+/** runArrowStream — Decode opts.records records into an Arrow IPC stream at opts.arrowPath. */
+int runArrowStream(const StreamOptions& opts);
+
+/** runParquetStream — Archive opts.records records as Parquet at opts.parquetPath. */
+int runParquetStream(const StreamOptions& opts);
+
+/** runTextStream — Write opts.records records as CSV / NDJSON at opts.csvPath / opts.ndjsonPath. */
+int runTextStream(const StreamOptions& opts);
+
+/** runBinaryStream — Write opts.records records as raw host-order TxnRecords at opts.binaryPath. */
+int runBinaryStream(const StreamOptions& opts);
+
+/** runStoreFiles — Write opts.records records to one file per store under opts.partitionDir. */
+int runStoreFiles(const StreamOptions& opts);
+
+/** runFileScan — runStream over the records of the export file opts.inputPath. */
+int runFileScan(const StreamOptions& opts);
+
+/** runWriteExport — Write opts.records generated records (TxnRecord, or opts.schemaPath's layout) to opts.exportPath. */
+int runWriteExport(const StreamOptions& opts);
+
+/** runPartitioned — runStream across opts.threads NUMA-placed workers (partitioned.cpp). */
+int runPartitioned(const StreamOptions& opts);
+
+/** runScaling — Partitioned throughput at 1 thread, one node, all threads. */
+int runScaling(const StreamOptions& opts);
+
+/** runTraining — The PGO training workload (`pos_modern --train`). */
+int runTraining(const StreamOptions& opts);
+
+/** runIngest — Serve the TCP ingest protocol on opts.listenPort until stopped. */
+int runIngest(const StreamOptions& opts);
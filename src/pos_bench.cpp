@@ -0,0 +1,507 @@
+// pos_bench.cpp — Hot-path benchmarks with a baseline regression gate
+//
+// Measures the batch kernels from txn_batch.h in isolation:
+//
+//   decode     GB/s of raw Big-Endian input turned into host-order records
+//   decode_schema  the same records through a runtime DecodePlan of the
+//              TxnRecord layout, specializations off (record_schema.h)
+//   decode_zoned  million 10-digit zoned-decimal fields/sec (decodeZonedBatch)
+//   convert_hfp   million Big-Endian IBM HFP64 values/sec to IEEE double
+//   swap_u32   GB/s of Big-Endian uint32 words swapped to host order by the
+//              generic fromBigEndianBatch (txn_record.h)
+//   encode_parquet  GB/s of raw input decoded into columns and encoded as
+//              Parquet row groups of 1Mi rows, one thread (parquet_writer.h)
+//   filter     million records/sec through filterBatch (about half kept)
+//   partition_stores  million records/sec grouped by store (partitionByStore)
+//   format     million records/sec rendered in the processTxn text layout
+//   format_csv / format_ndjson  million records/sec rendered as CSV or
+//              NDJSON rows (text_format.h)
+//   aggregate  million records/sec validated and summed into StoreTotals
+//
+// Each benchmark runs a warm-up pass and then --reps timed repetitions. The
+// repetitions, their mean and a 95% confidence interval are printed and,
+// with --json, written as machine-readable results.
+//
+// --compare BASELINE.json runs Welch's t-test per benchmark against a stored
+// result file. A benchmark counts as regressed only when it is BOTH slower
+// by more than --threshold percent AND statistically significant at 95%, so
+// neither run-to-run noise nor a trivially small but "significant" shift
+// fails the gate. The exit status is 1 if anything regressed.
+//
+// Compile:  cmake --build build --target pos_bench   (links the CMake pos library)
+// Run:      ./pos_bench --json bench.json
+//           ./pos_bench --compare ../bench/baseline.json
+//           ./pos_bench --verify DIR    (round-trip files; see verify-exports.py)
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <functional>
+#include <iomanip>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "ebcdic.h"
+#include "parquet_writer.h"
+#include "record_schema.h"
+#include "store_partition.h"
+#include "text_format.h"
+#include "txn_batch.h"
+#include "txn_record.h"
+
+// ---------------------------------------------------------------------------
+// Statistics
+// ---------------------------------------------------------------------------
+
+struct Summary {
+    double mean   = 0;
+    double stddev = 0;   // sample standard deviation
+    std::size_t n = 0;
+};
+
+Summary summarize(const std::vector<double>& xs) {
+    Summary s;
+    s.n = xs.size();
+    if (s.n == 0) return s;
+    for (double x : xs) s.mean += x;
+    s.mean /= static_cast<double>(s.n);
+    if (s.n > 1) {
+        double ss = 0;
+        for (double x : xs) ss += (x - s.mean) * (x - s.mean);
+        s.stddev = std::sqrt(ss / static_cast<double>(s.n - 1));
+    }
+    return s;
+}
+
+/**
+ * tCritical95 — Two-sided 97.5% quantile of Student's t with `df` degrees of
+ * freedom (Cornish–Fisher expansion around the normal quantile; within 0.5%
+ * of the exact value for df >= 3).
+ */
+double tCritical95(double df) {
+    const double z = 1.959964;
+    const double z3 = z * z * z, z5 = z3 * z * z, z7 = z5 * z * z;
+    return z + (z3 + z) / (4 * df)
+             + (5 * z5 + 16 * z3 + 3 * z) / (96 * df * df)
+             + (3 * z7 + 19 * z5 + 17 * z3 - 15 * z) / (384 * df * df * df);
+}
+
+double ci95HalfWidth(const Summary& s) {
+    if (s.n < 2) return 0;
+    return tCritical95(static_cast<double>(s.n - 1)) * s.stddev / std::sqrt(static_cast<double>(s.n));
+}
+
+// ---------------------------------------------------------------------------
+// Benchmarks
+// ---------------------------------------------------------------------------
+
+struct BenchResult {
+    std::string name;
+    std::string unit;
+    std::vector<double> samples;
+};
+
+/**
+ * runBench — Time `body` once to warm up, then `reps` times; each timed run
+ * is converted to a throughput with `work / seconds`.
+ */
+BenchResult runBench(const std::string& name, const std::string& unit, std::size_t reps,
+                     double work, const std::function<void()>& body) {
+    BenchResult r{name, unit, {}};
+    body();
+    for (std::size_t i = 0; i < reps; ++i) {
+        const auto start = std::chrono::steady_clock::now();
+        body();
+        const double secs = std::chrono::duration<double>(
+            std::chrono::steady_clock::now() - start).count();
+        r.samples.push_back(work / secs);
+    }
+    return r;
+}
+
+// Results feed this so the compiler cannot discard the benchmarked work.
+volatile uint64_t g_benchSink = 0;
+
+std::vector<BenchResult> runAll(std::size_t records, std::size_t reps) {
+    constexpr std::size_t kBatch = 1024;
+    const std::vector<char> raw = generateExport(records);
+    std::vector<TxnRecord> decoded(records);
+    decodeBatch(raw.data(), records, decoded.data());
+
+    std::vector<BenchResult> results;
+
+    results.push_back(runBench("decode", "GB/s", reps, static_cast<double>(raw.size()) / 1e9, [&] {
+        for (std::size_t off = 0; off < records; off += kBatch)
+            decodeBatch(raw.data() + off * sizeof(TxnRecord),
+                        std::min(kBatch, records - off), decoded.data() + off);
+        g_benchSink = g_benchSink + decoded[records / 2].txnId;
+    }));
+
+    RecordSchema schema;
+    std::string error;
+    parseSchema("record 16\n"
+                "txnId 0 4 be_uint\namountCents 4 4 be_uint\nstoreNumber 8 2 be_uint\n"
+                "pumpNumber 10 2 be_uint\ncardType 12 4 char\n", schema, error);
+    const DecodePlan plan = DecodePlan::build(schema, /*allowSpecialized=*/false);
+    std::vector<char> rows(plan.outputBytes(records));
+    results.push_back(runBench("decode_schema", "GB/s", reps, static_cast<double>(raw.size()) / 1e9, [&] {
+        for (std::size_t off = 0; off < records; off += kBatch)
+            plan.decode(raw.data() + off * sizeof(TxnRecord), std::min(kBatch, records - off),
+                        rows.data() + off * plan.rowBytes());
+        g_benchSink = g_benchSink + static_cast<uint64_t>(plan.integer(rows.data() + records / 2 * plan.rowBytes(), 0));
+    }));
+
+    // One 10-digit zoned field per 16-byte record, as in a partner export
+    std::vector<char> zoned(records * 16, 0x40);
+    for (std::size_t i = 0; i < records; ++i)
+        encodeZoned(static_cast<int64_t>(i * 7919 % 10'000'000'000) * (i % 5 ? 1 : -1), 10,
+                    zoned.data() + i * 16 + 4);
+    std::vector<int64_t> values(kBatch);
+    results.push_back(runBench("decode_zoned", "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+        for (std::size_t off = 0; off < records; off += kBatch)
+            decodeZonedBatch(zoned.data() + off * 16 + 4, 16, 10, std::min(kBatch, records - off),
+                             reinterpret_cast<char*>(values.data()), sizeof(int64_t));
+        g_benchSink = g_benchSink + static_cast<uint64_t>(values[0]);
+    }));
+
+    // HFP64 liters/rates: fractions and exponents around 16^0..16^4
+    std::vector<char> hfp(records * 8);
+    for (std::size_t i = 0; i < records; ++i)
+        storeBigEndian(hfp.data() + i * 8,
+                       uint64_t{0x40 + i % 5} << 56 | (0x100000000000ULL + i * 0x9E3779B97F4A7ULL) % (1ULL << 56));
+    std::vector<double> converted(records);
+    results.push_back(runBench("convert_hfp", "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+        for (std::size_t off = 0; off < records; off += kBatch)
+            convertHfp64Batch(hfp.data() + off * 8, std::min(kBatch, records - off), converted.data() + off);
+        g_benchSink = g_benchSink + static_cast<uint64_t>(converted[records / 2]);
+    }));
+
+    // The export read as plain uint32 words: the generic swap every column kernel starts from
+    constexpr std::size_t kWordBatch = kBatch * sizeof(TxnRecord) / sizeof(uint32_t);
+    const std::size_t words = raw.size() / sizeof(uint32_t);
+    std::vector<uint32_t> swapped(words);
+    results.push_back(runBench("swap_u32", "GB/s", reps, static_cast<double>(raw.size()) / 1e9, [&] {
+        for (std::size_t off = 0; off < words; off += kWordBatch)
+            fromBigEndianBatch(raw.data() + off * sizeof(uint32_t), std::min(kWordBatch, words - off),
+                               swapped.data() + off);
+        g_benchSink = g_benchSink + swapped[words / 2];
+    }));
+
+    constexpr std::size_t kRowGroup = std::size_t{1} << 20;
+    TxnArrowBatch columns(kRowGroup);
+    results.push_back(runBench("encode_parquet", "GB/s", reps, static_cast<double>(raw.size()) / 1e9, [&] {
+        std::size_t bytes = 0;
+        for (std::size_t off = 0; off < records; off += kRowGroup) {
+            columns.decode(raw.data() + off * sizeof(TxnRecord), std::min(kRowGroup, records - off));
+            for (const ParquetColumnChunk& chunk : ParquetWriter::encode(columns).columns)
+                bytes += chunk.bytes.size();
+        }
+        g_benchSink = g_benchSink + bytes;
+    }));
+
+    std::vector<TxnRecord> kept(kBatch);
+    const TxnFilter filter{25'000, 75'000, 110, 139};
+    results.push_back(runBench("filter", "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+        std::size_t total = 0;
+        for (std::size_t off = 0; off < records; off += kBatch)
+            total += filterBatch(decoded.data() + off, std::min(kBatch, records - off),
+                                 filter, kept.data());
+        g_benchSink = g_benchSink + total;
+    }));
+
+    StorePartition byStore;
+    results.push_back(runBench("partition_stores", "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+        std::size_t runs = 0;
+        for (std::size_t off = 0; off < records; off += kBatch) {
+            partitionByStore(decoded.data() + off, std::min(kBatch, records - off), byStore);
+            runs += byStore.runs.size();
+        }
+        g_benchSink = g_benchSink + runs;
+    }));
+
+    std::string text;
+    text.reserve(kBatch * 96);
+    results.push_back(runBench("format", "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+        uint64_t bytes = 0;
+        for (std::size_t off = 0; off < records; off += kBatch) {
+            text.clear();
+            formatBatch(decoded.data() + off, std::min(kBatch, records - off), text);
+            bytes += text.size();
+        }
+        g_benchSink = g_benchSink + bytes;
+    }));
+
+    for (const TextFormat textFormat : {TextFormat::kCsv, TextFormat::kNdjson}) {
+        const char* name = textFormat == TextFormat::kCsv ? "format_csv" : "format_ndjson";
+        results.push_back(runBench(name, "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+            uint64_t bytes = 0;
+            for (std::size_t off = 0; off < records; off += kBatch) {
+                text.clear();
+                formatRows(textFormat, decoded.data() + off, std::min(kBatch, records - off), text);
+                bytes += text.size();
+            }
+            g_benchSink = g_benchSink + bytes;
+        }));
+    }
+
+    results.push_back(runBench("aggregate", "Mrec/s", reps, static_cast<double>(records) / 1e6, [&] {
+        StoreTotals totals;
+        aggregateBatch(decoded.data(), records, totals);
+        g_benchSink = g_benchSink + totals.amountCents[100];
+    }));
+
+    return results;
+}
+
+// ---------------------------------------------------------------------------
+// JSON results
+//
+// The writer emits a fixed shape; the reader only needs the name/samples
+// pairs back, so it scans for them rather than parsing arbitrary JSON.
+// ---------------------------------------------------------------------------
+
+void writeJson(std::ostream& os, const std::vector<BenchResult>& results,
+               std::size_t records) {
+    os << std::setprecision(10) << "{\n  \"schema\": 1,\n  \"records\": " << records
+       << ",\n  \"benchmarks\": [\n";
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const auto& r = results[i];
+        const Summary s = summarize(r.samples);
+        const double hw = ci95HalfWidth(s);
+        os << "    {\"name\": \"" << r.name << "\", \"unit\": \"" << r.unit << "\", "
+           << "\"mean\": " << s.mean << ", \"stddev\": " << s.stddev << ", "
+           << "\"ci95\": [" << s.mean - hw << ", " << s.mean + hw << "], \"samples\": [";
+        for (std::size_t j = 0; j < r.samples.size(); ++j)
+            os << (j ? ", " : "") << r.samples[j];
+        os << "]}" << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    os << "  ]\n}\n";
+}
+
+bool readJson(const std::string& path, std::vector<BenchResult>& out) {
+    std::ifstream in(path);
+    if (!in) return false;
+    std::stringstream ss;
+    ss << in.rdbuf();
+    const std::string text = ss.str();
+
+    std::size_t pos = 0;
+    while ((pos = text.find("\"name\"", pos)) != std::string::npos) {
+        const std::size_t q1 = text.find('"', text.find(':', pos) + 1);
+        const std::size_t q2 = text.find('"', q1 + 1);
+        BenchResult r;
+        r.name = text.substr(q1 + 1, q2 - q1 - 1);
+
+        const std::size_t samples = text.find("\"samples\"", q2);
+        const std::size_t open = text.find('[', samples);
+        const std::size_t close = text.find(']', open);
+        if (samples == std::string::npos || open == std::string::npos || close == std::string::npos)
+            return false;
+        std::istringstream nums(text.substr(open + 1, close - open - 1));
+        for (std::string tok; std::getline(nums, tok, ',');)
+            r.samples.push_back(std::atof(tok.c_str()));
+        out.push_back(r);
+        pos = close;
+    }
+    return !out.empty();
+}
+
+// ---------------------------------------------------------------------------
+// Comparison (Welch's t-test, higher is better for every benchmark)
+// ---------------------------------------------------------------------------
+
+bool compare(const std::vector<BenchResult>& current, const std::vector<BenchResult>& baseline,
+             double thresholdPct) {
+    bool regressed = false;
+    std::cout << "\n=== Comparison against baseline ===\n"
+              << std::left << std::setw(14) << "benchmark" << std::right
+              << std::setw(14) << "baseline" << std::setw(14) << "current"
+              << std::setw(10) << "change" << std::setw(24) << "95% CI of change"
+              << "  verdict\n" << std::fixed;
+
+    for (const auto& cur : current) {
+        const BenchResult* base = nullptr;
+        for (const auto& b : baseline)
+            if (b.name == cur.name) base = &b;
+        if (!base) {
+            std::cout << std::left << std::setw(14) << cur.name << "  (not in baseline)\n";
+            continue;
+        }
+
+        const Summary c = summarize(cur.samples), b = summarize(base->samples);
+        const double vc = c.stddev * c.stddev / static_cast<double>(c.n);
+        const double vb = b.stddev * b.stddev / static_cast<double>(b.n);
+        const double se = std::sqrt(vc + vb);
+        // Welch–Satterthwaite degrees of freedom
+        const double df = se > 0
+            ? (vc + vb) * (vc + vb)
+              / (vc * vc / static_cast<double>(c.n - 1) + vb * vb / static_cast<double>(b.n - 1))
+            : 1e9;
+        const double diff = c.mean - b.mean;
+        const double hw = tCritical95(df) * se;
+
+        const double changePct = 100.0 * diff / b.mean;
+        const bool significant = diff + hw < 0;   // whole CI below zero
+        const bool bad = significant && changePct < -thresholdPct;
+        regressed = regressed || bad;
+
+        std::cout << std::left << std::setw(14) << cur.name << std::right
+                  << std::setprecision(3)
+                  << std::setw(14) << b.mean << std::setw(14) << c.mean
+                  << std::setprecision(1) << std::setw(9) << changePct << "%"
+                  << std::setw(11) << 100.0 * (diff - hw) / b.mean << "% .. "
+                  << std::setw(6) << 100.0 * (diff + hw) / b.mean << "%"
+                  << "  " << (bad ? "REGRESSION" : significant ? "slower (within threshold)" : "ok")
+                  << "\n";
+    }
+    return !regressed;
+}
+
+// ---------------------------------------------------------------------------
+// Export round trip (--verify DIR)
+//
+// Writes a small export with edge-case values in every output format, for
+// scripts/verify-exports.py to decode with independent readers and compare:
+//
+//   verify.bin      the raw Big-Endian records (the reference)
+//   verify.arrows   one record batch per group, verify.parquet one row group
+//   verify.csv / verify.ndjson
+//
+// Groups are 1, 13 and 131 rows (not multiples of 8 or 128), 1000, and one
+// of more than 64Ki distinct card types so that column falls back to PLAIN.
+// Values cycle through 0, powers of ten and one less, and UINT32_MAX /
+// UINT16_MAX; card types include blanks, CSV specials and Latin-1 bytes.
+// ---------------------------------------------------------------------------
+
+/** verifyExport — The records described above, Big-Endian. */
+std::vector<char> verifyExport(const std::vector<std::size_t>& groups) {
+    std::vector<uint32_t> edges32 = {0, UINT32_MAX, UINT32_MAX - 1};
+    for (uint32_t p = 1;; p *= 10) {
+        edges32.insert(edges32.end(), {p, p - 1, p + 1});
+        if (p > UINT32_MAX / 10) break;
+    }
+    const uint16_t edges16[] = {0, 1, 9, 10, 99, 100, 999, 1000, 9999, 10000, 65535, 65534};
+    const char* const cards[] = {"VISA", "MC  ", "    ", "A,\"B", "\xc9\xd1\xff ", "\x7f\x80x\\"};
+
+    std::size_t records = 0;
+    for (std::size_t g : groups) records += g;
+    std::vector<char> raw(records * sizeof(TxnRecord));
+    std::size_t i = 0;
+    for (std::size_t g = 0; g < groups.size(); ++g) {
+        const bool distinctCards = g + 1 == groups.size();
+        for (std::size_t r = 0; r < groups[g]; ++r, ++i) {
+            char* rec = raw.data() + i * sizeof(TxnRecord);
+            storeBigEndian(rec, i % 7 == 3 ? edges32[i % edges32.size()] : static_cast<uint32_t>(i + 1));
+            storeBigEndian(rec + 4, edges32[(i * 5) % edges32.size()]);
+            storeBigEndian(rec + 8, edges16[i % std::size(edges16)]);
+            storeBigEndian(rec + 10, edges16[(i * 7) % std::size(edges16)]);
+            if (distinctCards)
+                storeBigEndian(rec + 12, static_cast<uint32_t>(r * 2654435761u));
+            else
+                std::memcpy(rec + 12, cards[i % std::size(cards)], 4);
+        }
+    }
+    return raw;
+}
+
+/** writeVerifyFiles — verify.* in `dir`; false (with a message) on a write error. */
+bool writeVerifyFiles(const std::string& dir) {
+    const std::vector<std::size_t> groups = {1, 13, 131, 1000, 70001};
+    const std::vector<char> raw = verifyExport(groups);
+    const std::size_t records = raw.size() / sizeof(TxnRecord);
+    std::vector<TxnRecord> decoded(records);
+    decodeBatch(raw.data(), records, decoded.data());
+
+    std::ofstream bin(dir + "/verify.bin", std::ios::binary), arrows(dir + "/verify.arrows", std::ios::binary),
+                  parquet(dir + "/verify.parquet", std::ios::binary), csv(dir + "/verify.csv", std::ios::binary),
+                  ndjson(dir + "/verify.ndjson", std::ios::binary);
+    bin.write(raw.data(), static_cast<std::streamsize>(raw.size()));
+
+    ArrowIpcWriter arrowWriter(arrows);
+    ParquetWriter  parquetWriter(parquet);
+    TxnArrowBatch  columns(*std::max_element(groups.begin(), groups.end()));
+    std::string csvText(textHeader(TextFormat::kCsv)), ndjsonText(textHeader(TextFormat::kNdjson));
+    std::size_t off = 0;
+    for (std::size_t g : groups) {
+        columns.decode(raw.data() + off * sizeof(TxnRecord), g);
+        arrowWriter.write(columns);
+        parquetWriter.append(ParquetWriter::encode(columns));
+        formatRows(TextFormat::kCsv, decoded.data() + off, g, csvText);
+        formatRows(TextFormat::kNdjson, decoded.data() + off, g, ndjsonText);
+        off += g;
+    }
+    csv << csvText;
+    ndjson << ndjsonText;
+
+    const bool ok = arrowWriter.finish() & parquetWriter.finish() & bin.flush().good()
+                  & csv.flush().good() & ndjson.flush().good();
+    if (!ok) std::cerr << "cannot write the verify files in " << dir << "\n";
+    return ok;
+}
+
+int main(int argc, char** argv) {
+    std::size_t records = 1 << 22;   // 64 MiB of raw records
+    std::size_t reps    = 10;
+    double threshold    = 5.0;       // percent
+    std::string jsonPath, baselinePath, verifyDir;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const char* v = argv[i + 1];
+        if      (arg == "--records")   records = std::strtoull(v, nullptr, 10);
+        else if (arg == "--reps")      reps = std::strtoull(v, nullptr, 10);
+        else if (arg == "--threshold") threshold = std::atof(v);
+        else if (arg == "--json")      jsonPath = v;
+        else if (arg == "--compare")   baselinePath = v;
+        else if (arg == "--verify")    verifyDir = v;
+        else { records = 0; break; }
+    }
+    if (argc % 2 == 0 || records == 0 || reps < 2) {
+        std::cerr << "usage: " << argv[0] << " [--records N] [--reps N>=2]"
+                     " [--json OUT] [--compare BASELINE] [--threshold PCT] [--verify DIR]\n";
+        return 2;
+    }
+    if (!verifyDir.empty()) return writeVerifyFiles(verifyDir) ? 0 : 2;
+
+    std::vector<BenchResult> baseline;
+    if (!baselinePath.empty() && !readJson(baselinePath, baseline)) {
+        std::cerr << "cannot read baseline " << baselinePath << "\n";
+        return 2;
+    }
+
+    const std::vector<BenchResult> results = runAll(records, reps);
+
+    std::cout << "=== pos_bench: " << records << " records x " << reps << " reps, decode kernel "
+              << decodeKernelName() << " ===\n\n"
+              << std::left << std::setw(14) << "benchmark" << std::right
+              << std::setw(14) << "mean" << std::setw(26) << "95% CI" << "  unit\n"
+              << std::setprecision(3) << std::fixed;
+    for (const auto& r : results) {
+        const Summary s = summarize(r.samples);
+        const double hw = ci95HalfWidth(s);
+        std::cout << std::left << std::setw(14) << r.name << std::right
+                  << std::setw(14) << s.mean
+                  << std::setw(12) << s.mean - hw << " .. " << std::setw(10) << s.mean + hw
+                  << "  " << r.unit << "\n";
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream out(jsonPath);
+        writeJson(out, results, records);
+        if (!out) {
+            std::cerr << "cannot write " << jsonPath << "\n";
+            return 2;
+        }
+    }
+
+    if (!baselinePath.empty() && !compare(results, baseline, threshold))
+        return 1;
+    return 0;
+}
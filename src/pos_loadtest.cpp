@@ -0,0 +1,302 @@
+// pos_loadtest.cpp — Open-loop load generator for the pos_modern TCP ingest
+//
+// Replays Big-Endian TxnRecords (generated, or from a recorded export file)
+// into `pos_modern --listen PORT` on a fixed schedule and measures the time
+// until each message is acknowledged.
+//
+// Latency is measured from when a message was SCHEDULED to be sent, not when
+// it actually left: if the server stalls and the sender falls behind, the
+// messages that queued up behind the stall are charged for the wait. This
+// corrects for "coordinated omission", which otherwise hides exactly the
+// tail a capacity plan needs to see. Uncorrected figures are printed
+// alongside for comparison.
+//
+// Load shapes:
+//   fixed  constant rate for --duration seconds
+//   burst  same average rate, but --burst messages at a time
+//   ramp   --steps steps from --rate to --ramp-to, --duration seconds each;
+//          reports the saturation point (last step meeting the SLO)
+//
+// Compile:  g++ -std=c++20 -O2 -pthread -o pos_loadtest pos_loadtest.cpp txn_batch.cpp
+//           (or CMake: links libpos)
+// Run:      ./pos_modern --listen 9000 &
+//           ./pos_loadtest --port 9000 --mode ramp --rate 1000000 --ramp-to 20000000
+
+#include <iostream>
+#include <fstream>
+#include <cstring>
+#include <cstdint>
+#include <cstdlib>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "ingest_protocol.h"
+#include "latency_histogram.h"
+#include "txn_batch.h"
+
+// ---------------------------------------------------------------------------
+// Record source
+// ---------------------------------------------------------------------------
+
+constexpr std::size_t kRecordSize = sizeof(TxnRecord);   // OS/400 layout
+
+/** loadRecords — Read a recorded export; its size must be a multiple of 16. */
+bool loadRecords(const std::string& path, std::vector<char>& raw) {
+    std::ifstream in(path, std::ios::binary);
+    if (!in) return false;
+    raw.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    return !raw.empty() && raw.size() % kRecordSize == 0;
+}
+
+// ---------------------------------------------------------------------------
+// Options
+// ---------------------------------------------------------------------------
+
+struct LoadOptions {
+    std::string host        = "127.0.0.1";
+    uint16_t    port        = 9000;
+    std::string file;                       // recorded export; empty = generate
+    std::size_t records     = 1 << 20;      // generated pool size
+    std::string mode        = "fixed";      // fixed | burst | ramp
+    double      rate        = 1'000'000;    // records/sec (ramp: first step)
+    double      rampTo      = 0;            // records/sec at the last ramp step
+    std::size_t steps       = 5;
+    double      duration    = 5;            // seconds per step
+    std::size_t message     = 64;           // records per message
+    std::size_t burst       = 16;           // messages per burst
+    std::size_t connections = 1;
+    double      sloUs       = 1000;         // p99 objective for saturation
+};
+
+bool parseArgs(int argc, char** argv, LoadOptions& o) {
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        const char* v = argv[i + 1];
+        if      (arg == "--host")        o.host = v;
+        else if (arg == "--port")        o.port = static_cast<uint16_t>(std::atoi(v));
+        else if (arg == "--file")        o.file = v;
+        else if (arg == "--records")     o.records = std::strtoull(v, nullptr, 10);
+        else if (arg == "--mode")        o.mode = v;
+        else if (arg == "--rate")        o.rate = std::atof(v);
+        else if (arg == "--ramp-to")     o.rampTo = std::atof(v);
+        else if (arg == "--steps")       o.steps = std::strtoull(v, nullptr, 10);
+        else if (arg == "--duration")    o.duration = std::atof(v);
+        else if (arg == "--message")     o.message = std::strtoull(v, nullptr, 10);
+        else if (arg == "--burst")       o.burst = std::strtoull(v, nullptr, 10);
+        else if (arg == "--connections") o.connections = std::strtoull(v, nullptr, 10);
+        else if (arg == "--slo-us")      o.sloUs = std::atof(v);
+        else return false;
+    }
+    const bool modeOk = o.mode == "fixed" || o.mode == "burst" || o.mode == "ramp";
+    return argc % 2 == 1 && modeOk && o.rate > 0 && o.duration > 0 && o.records > 0
+        && o.message > 0 && o.message <= kIngestMaxRecords && o.burst > 0
+        && o.connections > 0 && o.steps > 0;
+}
+
+// ---------------------------------------------------------------------------
+// One load step on one connection
+//
+// The sender writes each message's scheduled and actual send times into its
+// slot before sending; the receiver reads the slot after the matching ack
+// arrives (acks come back in order).
+// ---------------------------------------------------------------------------
+
+inline uint64_t nowNs() {
+    return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+/** waitUntil — Sleep for long gaps, spin for the last ~50 µs. */
+inline void waitUntil(uint64_t deadline) {
+    for (uint64_t now = nowNs(); now < deadline; now = nowNs()) {
+        if (deadline - now > 100'000)
+            std::this_thread::sleep_for(std::chrono::nanoseconds(deadline - now - 50'000));
+    }
+}
+
+struct StepResult {
+    LatencyHistogram corrected;     // ack − scheduled send
+    LatencyHistogram uncorrected;   // ack − actual send
+    uint64_t records = 0;           // records acknowledged
+    uint64_t lastAck = 0;
+    std::atomic<bool> failed{false};   // set by either thread of the step
+};
+
+struct Slot {
+    std::atomic<uint64_t> scheduled{0};
+    uint64_t sent = 0;
+};
+
+void runConnectionStep(int fd, const std::vector<char>& pool, std::size_t poolOffset,
+                       const LoadOptions& o, double rate, uint64_t start, StepResult& result) {
+    // Per-connection share of the rate, expressed as a message interval.
+    const double interval = 1e9 * static_cast<double>(o.message * o.connections) / rate;
+    const std::size_t total = std::max<std::size_t>(
+        1, static_cast<std::size_t>(o.duration * 1e9 / interval));
+    const std::size_t burst = o.mode == "burst" ? o.burst : 1;
+    auto slots = std::make_unique<Slot[]>(total);
+
+    std::thread receiver([&] {
+        for (std::size_t k = 0; k < total; ++k) {
+            uint32_t ackBe;
+            if (!recvFull(fd, &ackBe, sizeof(ackBe))) { result.failed.store(true); return; }
+            const uint64_t now = nowNs();
+            uint64_t scheduled;
+            while ((scheduled = slots[k].scheduled.load(std::memory_order_acquire)) == 0) {}
+            result.corrected.record(now - scheduled);
+            result.uncorrected.record(now - slots[k].sent);
+            result.records += o.message;
+            result.lastAck = now;
+        }
+    });
+
+    const std::size_t poolRecords = pool.size() / kRecordSize;
+    std::vector<char> msg(4 + o.message * kRecordSize);
+    storeBigEndian(msg.data(), static_cast<uint32_t>(o.message));
+    std::size_t cursor = poolOffset % poolRecords;
+
+    for (std::size_t k = 0; k < total && !result.failed.load(std::memory_order_relaxed); ++k) {
+        for (std::size_t r = 0; r < o.message; ++r, cursor = (cursor + 1) % poolRecords)
+            std::memcpy(msg.data() + 4 + r * kRecordSize, pool.data() + cursor * kRecordSize,
+                        kRecordSize);
+
+        // A burst shares one scheduled time; the average rate is unchanged.
+        const uint64_t scheduled = start + static_cast<uint64_t>(
+            static_cast<double>(k / burst * burst) * interval);
+        waitUntil(scheduled);
+        slots[k].sent = nowNs();
+        slots[k].scheduled.store(scheduled, std::memory_order_release);
+        if (!sendFull(fd, msg.data(), msg.size())) {
+            result.failed.store(true);
+            ::shutdown(fd, SHUT_RDWR);   // the acks for unsent messages will never come
+            break;
+        }
+    }
+    receiver.join();
+}
+
+int connectTo(const LoadOptions& o) {
+    const int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr{};
+    addr.sin_family = AF_INET;
+    addr.sin_port   = htons(o.port);
+    if (fd < 0 || ::inet_pton(AF_INET, o.host.c_str(), &addr.sin_addr) != 1
+        || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        if (fd >= 0) ::close(fd);
+        return -1;
+    }
+    const int one = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &one, sizeof(one));
+    return fd;
+}
+
+int main(int argc, char** argv) {
+    LoadOptions o;
+    if (!parseArgs(argc, argv, o)) {
+        std::cerr << "usage: " << argv[0] << " [--host H] [--port P]"
+                     " [--file EXPORT | --records N] [--mode fixed|burst|ramp]"
+                     " [--rate REC/S] [--ramp-to REC/S] [--steps K] [--duration S]"
+                     " [--message N] [--burst N] [--connections N] [--slo-us U]\n";
+        return 2;
+    }
+
+    std::vector<char> pool;
+    if (!o.file.empty()) {
+        if (!loadRecords(o.file, pool)) {
+            std::cerr << "cannot load " << o.file << " (must be whole 16-byte records)\n";
+            return 1;
+        }
+    } else {
+        pool = generateExport(o.records);   // exactly what `pos_modern --records N` replays
+    }
+
+    std::vector<int> fds;
+    for (std::size_t c = 0; c < o.connections; ++c) {
+        const int fd = connectTo(o);
+        if (fd < 0) {
+            std::cerr << "cannot connect to " << o.host << ":" << o.port << "\n";
+            return 1;
+        }
+        fds.push_back(fd);
+    }
+
+    const std::size_t steps = o.mode == "ramp" ? o.steps : 1;
+    const double rampTo = o.rampTo > 0 ? o.rampTo : o.rate;
+
+    std::cout << "=== pos_loadtest: " << o.mode << ", " << o.connections << " connection(s), "
+              << o.message << " records/message ===\n\n"
+              << std::right << std::setw(14) << "target rec/s" << std::setw(16) << "achieved rec/s"
+              << std::setw(11) << "p50 us"  << std::setw(11) << "p99 us"
+              << std::setw(11) << "p99.9 us" << std::setw(11) << "max us"
+              << std::setw(15) << "p99 uncorr us" << "\n"
+              << std::fixed << std::setprecision(1);
+
+    double saturation = 0;
+    bool saturated = false;
+    for (std::size_t s = 0; s < steps; ++s) {
+        const double rate = steps == 1 ? o.rate
+            : o.rate + (rampTo - o.rate) * static_cast<double>(s) / static_cast<double>(steps - 1);
+
+        std::vector<std::unique_ptr<StepResult>> results;
+        std::vector<std::thread> threads;
+        const uint64_t start = nowNs() + 1'000'000;   // 1 ms to start all connections
+        for (std::size_t c = 0; c < fds.size(); ++c) {
+            results.push_back(std::make_unique<StepResult>());
+            threads.emplace_back(runConnectionStep, fds[c], std::cref(pool),
+                                 c * 7919, std::cref(o), rate, start, std::ref(*results.back()));
+        }
+        for (auto& t : threads) t.join();
+
+        HistogramSnapshot corrected, uncorrected;
+        uint64_t records = 0, lastAck = start;
+        for (const auto& r : results) {
+            if (r->failed) {
+                std::cerr << "connection lost during step " << s + 1 << "\n";
+                return 1;
+            }
+            corrected.merge(r->corrected);
+            uncorrected.merge(r->uncorrected);
+            records += r->records;
+            lastAck = std::max(lastAck, r->lastAck);
+        }
+        const double achieved = static_cast<double>(records) * 1e9
+                              / static_cast<double>(lastAck - start);
+        auto us = [](uint64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+        std::cout << std::setw(14) << rate << std::setw(16) << achieved
+                  << std::setw(11) << us(corrected.percentile(0.50))
+                  << std::setw(11) << us(corrected.percentile(0.99))
+                  << std::setw(11) << us(corrected.percentile(0.999))
+                  << std::setw(11) << us(corrected.max())
+                  << std::setw(15) << us(uncorrected.percentile(0.99)) << "\n";
+
+        const bool meetsSlo = achieved >= 0.95 * rate
+                           && us(corrected.percentile(0.99)) <= o.sloUs;
+        if (!meetsSlo) { saturated = true; break; }
+        saturation = rate;
+    }
+
+    std::cout << "\n";
+    if (saturated && saturation > 0)
+        std::cout << "Saturation : ~" << saturation << " rec/s (last step with p99 <= "
+                  << o.sloUs << " us and >= 95% of target)\n";
+    else if (saturated)
+        std::cout << "Saturation : below the first step (" << o.rate << " rec/s)\n";
+    else
+        std::cout << "Saturation : not reached (all steps met p99 <= " << o.sloUs << " us)\n";
+
+    for (int fd : fds) ::close(fd);
+    return 0;
+}
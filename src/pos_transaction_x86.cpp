@@ -4,82 +4,35 @@
 // This is the REFACTORED version of pos_transaction.cpp. It correctly reads
 // Big-Endian binary data (from a legacy OS/400 flat file) on an x86 host.
 //
-// Compile:  g++ -std=c++20 -o pos_modern pos_transaction_x86.cpp
-// Run:      ./pos_modern
+// Compile:  g++ -std=c++20 -O2 -pthread -o pos_modern pos_transaction_x86.cpp
+//               pipeline.cpp partitioned.cpp ingest_server.cpp
+//               multi_record.cpp rdw_framing.cpp record_schema.cpp
+//               zoned_decimal.cpp arrow_ipc.cpp parquet_writer.cpp
+//               text_format.cpp binary_writer.cpp store_partition.cpp
+//               uring_writer.cpp export_reader.cpp txn_batch.cpp  (or CMake: libpos)
+// Run:      ./pos_modern                      (single-record demo)
+//           ./pos_modern --records 10000000   (streaming pipeline)
+//           ./pos_modern --listen 9000        (TCP ingest daemon)
+//           ./pos_modern --records 100000000 --threads 16   (NUMA-partitioned)
+//           ./pos_modern --schema schemas/partner_fuel.schema   (runtime layout)
+//           ./pos_modern --records 10000000 --arrow txns.arrows   (Arrow IPC)
+//           ./pos_modern --records 100000000 --parquet txns.parquet --threads 8
+//           ./pos_modern --records 100000000 --csv txns.csv --threads 8   (or --ndjson)
+//           ./pos_modern --records 100000000 --binary - | consumer   (raw 16-byte records)
+//           ./pos_modern --records 100000000 --partition-dir stores --partition-format csv
+//           ./pos_modern --records 100000000 --binary txns.bin --uring --durability-ms 100
+//           ./pos_modern --input export.bin --read-mode direct   (scan an export file)
+//           ./pos_modern --train              (PGO training workload)
 
 #include <iostream>
 #include <cstring>
 #include <cstdint>
-#include <bit>       // C++20: std::endian for compile-time byte-order detection
+#include <cstdlib>
+#include <memory>
+#include <string>
 
-// ---------------------------------------------------------------------------
-// Portable byte-swap utilities
-//
-// These functions convert multi-byte integers from Big-Endian (the source
-// data format on OS/400) to the host CPU's native byte order.
-//
-// On a Little-Endian host (x86), the bytes are reversed.
-// On a Big-Endian host, the functions are no-ops (zero overhead).
-//
-// The `if constexpr` check is resolved at COMPILE TIME — there is no
-// runtime branching cost.
-// ---------------------------------------------------------------------------
-
-/**
- * fromBigEndian32 — Convert a 32-bit Big-Endian value to host byte order.
- */
-inline uint32_t fromBigEndian32(uint32_t v) {
-    if constexpr (std::endian::native == std::endian::big)
-        return v;  // Already in the correct order
-
-    // Use compiler intrinsics for single-instruction byte reversal
-    #if defined(__GNUC__) || defined(__clang__)
-        return __builtin_bswap32(v);
-    #elif defined(_MSC_VER)
-        return _byteswap_ulong(v);
-    #else
-        // Manual fallback — portable to any C++ compiler
-        return ((v >> 24) & 0x000000FF)
-             | ((v >>  8) & 0x0000FF00)
-             | ((v <<  8) & 0x00FF0000)
-             | ((v << 24) & 0xFF000000);
-    #endif
-}
-
-/**
- * fromBigEndian16 — Convert a 16-bit Big-Endian value to host byte order.
- */
-inline uint16_t fromBigEndian16(uint16_t v) {
-    if constexpr (std::endian::native == std::endian::big)
-        return v;
-
-    #if defined(__GNUC__) || defined(__clang__)
-        return __builtin_bswap16(v);
-    #elif defined(_MSC_VER)
-        return _byteswap_ushort(v);
-    #else
-        return static_cast<uint16_t>((v >> 8) | (v << 8));
-    #endif
-}
-
-// ---------------------------------------------------------------------------
-// TxnRecord: UNCHANGED struct layout.
-//
-// The binary format is identical to the OS/400 version. This is critical:
-// it means existing data files, network packets, and legacy exports remain
-// compatible without any reformatting.
-// ---------------------------------------------------------------------------
-struct TxnRecord {
-    uint32_t txnId;          // 4 bytes — Transaction ID
-    uint32_t amountCents;    // 4 bytes — Amount in cents (5000 = $50.00)
-    uint16_t storeNumber;    // 2 bytes — Store identifier
-    uint16_t pumpNumber;     // 2 bytes — Fuel pump number
-    char     cardType[4];    // 4 bytes — Card type ("VISA", "MC", etc.)
-};
-
-// Compile-time guard: ensure no unexpected padding was inserted
-static_assert(sizeof(TxnRecord) == 16,
-    "TxnRecord size mismatch — check struct alignment/padding");
+#include "pipeline.h"
+#include "txn_record.h"
 
 // ---------------------------------------------------------------------------
 // processTxn — REFACTORED for x86
@@ -112,7 +65,116 @@ void processTxn(const char* rawBuffer) {
     std::cout << "\n";
 }
 
-int main() {
+// ---------------------------------------------------------------------------
+// Command line
+//
+// The pipeline itself lives in libpos (pipeline.h, txn_batch.h); this file is
+// the CLI over it plus the original single-record demo.
+// ---------------------------------------------------------------------------
+
+/**
+ * parseArgs — Minimal flag parser; returns false (after printing usage) on
+ * an unknown flag, a missing/zero value, or --input with a framing it cannot
+ * read.
+ */
+bool parseArgs(int argc, char** argv, StreamOptions& opts) {
+    for (int i = 1; i < argc; ++i) {
+        const std::string arg = argv[i];
+        if (arg == "--follow" || arg == "--perf" || arg == "--train" || arg == "--scaling"
+            || arg == "--uring" || arg == "--direct" || arg == "--keep-cache") {
+            (arg == "--follow" ? opts.follow : arg == "--perf" ? opts.perf
+                 : arg == "--train" ? opts.train : arg == "--uring" ? opts.uring
+                 : arg == "--direct" ? opts.direct
+                 : arg == "--keep-cache" ? opts.keepCache : opts.scaling) = true;
+            continue;
+        }
+        if (arg == "--numa" && i + 1 < argc) {
+            const std::string policy = argv[++i];
+            opts.numa = policy == "off" ? NumaPolicy::kOff
+                      : policy == "interleave" ? NumaPolicy::kInterleave : NumaPolicy::kLocal;
+            if (policy == "off" || policy == "interleave" || policy == "local") continue;
+            --i;
+        }
+        if (arg == "--partition-format" && i + 1 < argc) {
+            const std::string format = argv[++i];
+            opts.partitionFormat = format == "csv" ? StoreFileFormat::kCsv
+                                 : format == "ndjson" ? StoreFileFormat::kNdjson : StoreFileFormat::kRaw;
+            if (format == "raw" || format == "csv" || format == "ndjson") continue;
+            --i;
+        }
+        if (arg == "--read-mode" && i + 1 < argc) {
+            const std::string mode = argv[++i];
+            opts.readMode = mode == "mmap" ? ReadMode::kMmap
+                          : mode == "direct" ? ReadMode::kDirect : ReadMode::kBuffered;
+            if (mode == "buffered" || mode == "mmap" || mode == "direct") continue;
+            --i;
+        }
+        if ((arg == "--trace" || arg == "--record-types" || arg == "--rdw" || arg == "--schema"
+             || arg == "--arrow" || arg == "--parquet" || arg == "--csv" || arg == "--ndjson"
+             || arg == "--binary" || arg == "--partition-dir" || arg == "--input"
+             || arg == "--write-export")
+            && i + 1 < argc) {
+            (arg == "--trace" ? opts.tracePath
+             : arg == "--rdw" ? opts.rdw
+             : arg == "--schema" ? opts.schemaPath
+             : arg == "--arrow" ? opts.arrowPath
+             : arg == "--parquet" ? opts.parquetPath
+             : arg == "--csv" ? opts.csvPath
+             : arg == "--ndjson" ? opts.ndjsonPath
+             : arg == "--binary" ? opts.binaryPath
+             : arg == "--partition-dir" ? opts.partitionDir
+             : arg == "--input" ? opts.inputPath
+             : arg == "--write-export" ? opts.exportPath : opts.recordTypes) = argv[++i];
+            continue;
+        }
+        std::size_t* target = arg == "--records"      ? &opts.records
+                            : arg == "--batch"        ? &opts.batch
+                            : arg == "--sample-every" ? &opts.sampleEvery
+                            : arg == "--metrics-port" ? &opts.metricsPort
+                            : arg == "--listen"       ? &opts.listenPort
+                            : arg == "--threads"      ? &opts.threads
+                            : arg == "--row-group"    ? &opts.rowGroup
+                            : arg == "--open-files"   ? &opts.openFiles
+                            : arg == "--durability-ms" ? &opts.durabilityMs
+                            : nullptr;
+        if (!target || i + 1 >= argc || (*target = std::strtoull(argv[++i], nullptr, 10)) == 0) {
+            std::cerr << "usage: " << argv[0]
+                      << " [--records N] [--batch N] [--sample-every N]"
+                         " [--metrics-port P] [--follow] [--perf] [--trace FILE]"
+                         " [--listen PORT] [--train] [--threads N]"
+                         " [--numa local|interleave|off] [--scaling]"
+                         " [--record-types SPEC] [--rdw rdw|2|4] [--schema FILE]"
+                         " [--arrow FILE] [--parquet FILE] [--row-group N]"
+                         " [--csv FILE] [--ndjson FILE] [--binary FILE|-]"
+                         " [--partition-dir DIR] [--partition-format raw|csv|ndjson]"
+                         " [--open-files N] [--uring] [--durability-ms N] [--direct]"
+                         " [--input FILE] [--read-mode buffered|mmap|direct] [--keep-cache]"
+                         " [--write-export FILE]\n";
+            return false;
+        }
+    }
+    if (!opts.inputPath.empty() && (!opts.recordTypes.empty() || !opts.rdw.empty() || !opts.exportPath.empty())) {
+        std::cerr << argv[0] << ": --input reads fixed-length records (TxnRecord or --schema);"
+                     " it cannot be combined with --record-types, --rdw or --write-export\n";
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv) {
+    StreamOptions opts;
+    if (!parseArgs(argc, argv, opts))
+        return 2;
+    if (opts.train)
+        return runTraining(opts);
+    if (opts.listenPort != 0)
+        return runIngest(opts);
+    if (opts.records != 0 || opts.scaling || !opts.schemaPath.empty() || !opts.arrowPath.empty()
+        || !opts.parquetPath.empty() || !opts.csvPath.empty() || !opts.ndjsonPath.empty()
+        || !opts.binaryPath.empty() || !opts.partitionDir.empty()
+        || !opts.inputPath.empty() || !opts.exportPath.empty())
+        return runStream(opts);
+
     // Same Big-Endian buffer as the legacy version.
     // The DATA has not changed — only the INTERPRETATION has.
     const char buffer[] = {
@@ -124,7 +186,14 @@ int main() {
     };
 
     std::cout << "=== Modernized x86 Transaction Processing ===\n\n";
+    const std::unique_ptr<PerfCounterGroup> perf = openPerf(opts);
+    const PerfSample before = perf ? perf->read() : PerfSample{};
     processTxn(buffer);
+    if (perf) {
+        PerfStageStats stats({"processTxn"});
+        stats.add(0, perf->read() - before, 1);
+        stats.report(std::cerr);
+    }
 
     return 0;
 }
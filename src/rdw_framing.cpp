@@ -0,0 +1,184 @@
+// rdw_framing.cpp — Serial and speculative-parallel framing of RDW exports
+
+#include "rdw_framing.h"
+
+#include <algorithm>
+#include <numeric>
+#include <thread>
+
+#include "txn_batch.h"
+
+namespace {
+
+// A speculative start must be followed by this many plausible lengths
+constexpr std::size_t kConfirmHops = 4;
+
+// How far into its range a chunk looks for a plausible start
+constexpr std::size_t kSearchBytes = 64 * 1024;
+
+/**
+ * ChunkFrame — One chunk's speculative chain: offsets in [begin, end) plus
+ * the first offset at or past `end` (where the chain enters the next chunk).
+ */
+struct ChunkFrame {
+    std::vector<uint64_t> offsets;
+    uint64_t              exit = 0;
+};
+
+/** plausibleStart — Do kConfirmHops lengths chain from `p` inside the data? */
+bool plausibleStart(const char* data, std::size_t size, uint64_t p, const RdwFormat& format) {
+    for (std::size_t hop = 0; hop < kConfirmHops && p < size; ++hop) {
+        if (size - p < format.prefixBytes()) return false;
+        const std::size_t len = recordLength(data + p, format);
+        if (len == 0 || len > size - p) return false;
+        p += len;
+    }
+    return true;
+}
+
+/** chainFrom — Follow lengths from `p` until `end` or an invalid length. */
+void chainFrom(const char* data, std::size_t size, uint64_t p, uint64_t end,
+               const RdwFormat& format, ChunkFrame& out) {
+    while (p < end) {
+        const std::size_t len = size - p >= format.prefixBytes() ? recordLength(data + p, format) : 0;
+        if (len == 0 || len > size - p) break;   // wrong guess; the fix-up pass takes over
+        out.offsets.push_back(p);
+        p += len;
+    }
+    out.exit = p;
+}
+
+}  // namespace
+
+bool parseRdwFormat(const std::string& name, RdwFormat& format) {
+    if (name == "rdw") format.prefix = RdwPrefix::kIbmRdw;
+    else if (name == "2") format.prefix = RdwPrefix::kPrefix2;
+    else if (name == "4") format.prefix = RdwPrefix::kPrefix4;
+    else return false;
+    return true;
+}
+
+bool frameRecords(const char* data, std::size_t size, const RdwFormat& format,
+                  std::vector<uint64_t>& offsets, std::string& error) {
+    offsets.clear();
+    uint64_t p = 0;
+    while (p < size) {
+        const std::size_t len = size - p >= format.prefixBytes() ? recordLength(data + p, format) : 0;
+        if (len == 0 || len > size - p) {
+            error = "invalid record length at byte " + std::to_string(p);
+            return false;
+        }
+        offsets.push_back(p);
+        p += len;
+    }
+    return true;
+}
+
+bool frameRecordsParallel(const char* data, std::size_t size, const RdwFormat& format,
+                          std::size_t threads, std::vector<uint64_t>& offsets,
+                          std::string& error) {
+    // Chunks much smaller than the speculation window are not worth a thread
+    threads = std::max<std::size_t>(1, std::min(threads, size / (4 * kSearchBytes)));
+    if (threads == 1) return frameRecords(data, size, format, offsets, error);
+
+    std::vector<uint64_t> bounds(threads + 1);
+    for (std::size_t t = 0; t <= threads; ++t) bounds[t] = t * size / threads;
+
+    // 1. Speculative chains, one per chunk
+    std::vector<ChunkFrame> chunks(threads);
+    std::vector<std::thread> workers;
+    for (std::size_t t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            uint64_t start = bounds[t];
+            if (t > 0) {
+                const uint64_t limit = std::min<uint64_t>(bounds[t] + kSearchBytes, bounds[t + 1]);
+                while (start < limit && !plausibleStart(data, size, start, format)) ++start;
+                if (start == limit) {
+                    chunks[t].exit = bounds[t];    // no guess; fix-up frames this chunk
+                    return;
+                }
+            }
+            chainFrom(data, size, start, bounds[t + 1], format, chunks[t]);
+        });
+    for (auto& w : workers) w.join();
+    workers.clear();
+
+    // 2. Serial fix-up: walk the true chain into each chunk until it joins
+    //    the speculative one
+    for (std::size_t t = 0; t < threads; ++t) {
+        ChunkFrame& c = chunks[t];
+        uint64_t p = t == 0 ? 0 : chunks[t - 1].exit;
+        std::vector<uint64_t> walked;
+        for (;;) {
+            if (p >= bounds[t + 1] || p >= size) {
+                c.offsets = std::move(walked);      // speculation never joined
+                c.exit = p;
+                break;
+            }
+            const auto hit = std::lower_bound(c.offsets.begin(), c.offsets.end(), p);
+            if (hit != c.offsets.end() && *hit == p) {
+                // Joined: the rest of the speculative chain is the true chain,
+                // unless it stopped early on a length that really is invalid
+                c.offsets.erase(c.offsets.begin(), hit);
+                c.offsets.insert(c.offsets.begin(), walked.begin(), walked.end());
+                if (c.exit < bounds[t + 1] && c.exit < size) {
+                    p = c.exit;
+                    walked = std::move(c.offsets);
+                    c.offsets.clear();
+                    continue;
+                }
+                break;
+            }
+            const std::size_t len = size - p >= format.prefixBytes() ? recordLength(data + p, format) : 0;
+            if (len == 0 || len > size - p) {
+                error = "invalid record length at byte " + std::to_string(p);
+                return false;
+            }
+            walked.push_back(p);
+            p += len;
+        }
+    }
+
+    // 3. Exclusive prefix sum of chunk counts → each chunk's output slot
+    std::vector<std::size_t> slot(threads + 1, 0);
+    std::transform_exclusive_scan(chunks.begin(), chunks.end(), slot.begin(), std::size_t{0},
+                                  std::plus<>{}, [](const ChunkFrame& c) { return c.offsets.size(); });
+    slot[threads] = slot[threads - 1] + chunks[threads - 1].offsets.size();
+    offsets.resize(slot[threads]);
+    for (std::size_t t = 0; t < threads; ++t)
+        workers.emplace_back([&, t] {
+            std::copy(chunks[t].offsets.begin(), chunks[t].offsets.end(), offsets.begin() + slot[t]);
+        });
+    for (auto& w : workers) w.join();
+    return true;
+}
+
+std::vector<char> generateVariableExport(std::size_t count, const RdwFormat& format) {
+    static const char kMemo[] = "LOYALTY 4411 2231 9004 REDEEMED 250 PTS CARWASH";
+    const std::vector<char> fixed = generateExport(count);
+    const std::size_t prefix = format.prefixBytes();
+
+    std::vector<char> raw;
+    raw.reserve(count * (prefix + sizeof(TxnRecord) + 24));
+    for (std::size_t i = 0; i < count; ++i) {
+        const std::size_t memo = (i * 31) % 48;
+        const std::size_t body = sizeof(TxnRecord) + memo;
+        char len[4] = {};
+        switch (format.prefix) {
+        case RdwPrefix::kIbmRdw:
+            storeBigEndian(len, static_cast<uint16_t>(body + 4));
+            break;
+        case RdwPrefix::kPrefix2:
+            storeBigEndian(len, static_cast<uint16_t>(body));
+            break;
+        default:
+            storeBigEndian(len, static_cast<uint32_t>(body));
+            break;
+        }
+        raw.insert(raw.end(), len, len + prefix);
+        raw.insert(raw.end(), fixed.data() + i * sizeof(TxnRecord),
+                   fixed.data() + (i + 1) * sizeof(TxnRecord));
+        raw.insert(raw.end(), kMemo, kMemo + memo);
+    }
+    return raw;
+}
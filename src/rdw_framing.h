@@ -0,0 +1,106 @@
+// rdw_framing.h — Variable-length records with a Big-Endian length prefix
+//
+// Some IBM i exports write variable-length records: each starts with its
+// length, and the next record starts where that length says. Three prefixes
+// are supported (RdwFormat):
+//
+//   kIbmRdw   4-byte RDW: uint16 LL (Big-Endian, includes the RDW) + 2 zero bytes
+//   kPrefix2  uint16 length of the body that follows
+//   kPrefix4  uint32 length of the body that follows
+//
+// In this pipeline the body is a TxnRecord followed by an optional
+// variable-length memo, so every body is at least 16 bytes.
+//
+// Framing — finding where each record starts — is a pointer chase: record
+// i+1's offset depends on record i's length. frameRecordsParallel still
+// splits the work across threads:
+//
+//   1. every chunk except the first searches the start of its byte range
+//      for a position where several consecutive length fields are plausible
+//      and chains from there (speculation)
+//   2. a serial fix-up pass walks the true chain into each chunk until it
+//      meets the speculative one; with real data they meet on the first
+//      record, so this pass touches a handful of records per chunk
+//   3. an exclusive prefix sum over the per-chunk record counts gives each
+//      chunk its slot in the output, and the chunks copy their offsets in
+//      parallel
+//
+// A wrong speculation costs time, never correctness: the fix-up pass alone
+// would frame the whole buffer.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "txn_record.h"
+
+enum class RdwPrefix { kIbmRdw, kPrefix2, kPrefix4 };
+
+struct RdwFormat {
+    RdwPrefix prefix = RdwPrefix::kIbmRdw;
+
+    std::size_t prefixBytes() const { return prefix == RdwPrefix::kPrefix2 ? 2 : 4; }
+    std::size_t minRecord() const { return prefixBytes() + sizeof(TxnRecord); }
+    std::size_t maxRecord() const {
+        return prefix == RdwPrefix::kIbmRdw  ? 32756
+             : prefix == RdwPrefix::kPrefix2 ? 2 + 65535
+                                             : 4 + (std::size_t{1} << 20);
+    }
+};
+
+/** parseRdwFormat — "rdw", "2" or "4"; false for anything else. */
+bool parseRdwFormat(const std::string& name, RdwFormat& format);
+
+/**
+ * recordLength — Total bytes (prefix included) of the record at `p`, or 0
+ * if its prefix is not a valid length for `format`.
+ */
+inline std::size_t recordLength(const char* p, const RdwFormat& format) {
+    std::size_t len;
+    switch (format.prefix) {
+    case RdwPrefix::kIbmRdw:
+        if (loadBigEndian<uint16_t>(p + 2) != 0) return 0;
+        len = loadBigEndian<uint16_t>(p);
+        break;
+    case RdwPrefix::kPrefix2:
+        len = 2 + std::size_t{loadBigEndian<uint16_t>(p)};
+        break;
+    default:
+        len = 4 + std::size_t{loadBigEndian<uint32_t>(p)};
+        break;
+    }
+    return len >= format.minRecord() && len <= format.maxRecord() ? len : 0;
+}
+
+/**
+ * frameRecords — Offsets of every record in `data`, in order. False (with
+ * `error` set) on an invalid length or a record that runs past the end.
+ */
+bool frameRecords(const char* data, std::size_t size, const RdwFormat& format,
+                  std::vector<uint64_t>& offsets, std::string& error);
+
+/** frameRecordsParallel — frameRecords split over `threads` threads (see above). */
+bool frameRecordsParallel(const char* data, std::size_t size, const RdwFormat& format,
+                          std::size_t threads, std::vector<uint64_t>& offsets,
+                          std::string& error);
+
+/**
+ * gatherTxns — Copy the TxnRecord at the front of each framed record's body
+ * into `out` (still Big-Endian, contiguous) for decodeBatch.
+ */
+inline void gatherTxns(const char* data, const uint64_t* offsets, std::size_t count,
+                       const RdwFormat& format, char* out) {
+    const std::size_t skip = format.prefixBytes();
+    for (std::size_t i = 0; i < count; ++i)
+        std::memcpy(out + i * sizeof(TxnRecord), data + offsets[i] + skip, sizeof(TxnRecord));
+}
+
+/**
+ * generateVariableExport — `count` records as generateExport, each followed
+ * by a memo of 0–47 bytes, in `format`.
+ */
+std::vector<char> generateVariableExport(std::size_t count, const RdwFormat& format);
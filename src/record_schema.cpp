@@ -0,0 +1,363 @@
+// record_schema.cpp — Schema parsing, decode-plan compilation and execution
+
+#include "record_schema.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include "ebcdic.h"
+#include "multiversion.h"
+#include "txn_batch.h"
+
+namespace {
+
+struct TypeInfo {
+    const char* name;
+    FieldType   type;
+};
+
+constexpr TypeInfo kTypes[] = {
+    {"be_uint", FieldType::kBeUnsigned}, {"be_int", FieldType::kBeSigned},
+    {"char", FieldType::kChar},          {"ebcdic", FieldType::kEbcdic},
+    {"comp3", FieldType::kPacked},       {"zoned", FieldType::kZoned},
+};
+
+bool isInteger(FieldType t) { return t == FieldType::kBeUnsigned || t == FieldType::kBeSigned; }
+bool isText(FieldType t)    { return t == FieldType::kChar || t == FieldType::kEbcdic; }
+
+/** widthAllowed — The widths parseSchema accepts for each type. */
+bool widthAllowed(FieldType t, std::size_t w) {
+    switch (t) {
+    case FieldType::kBeUnsigned:
+    case FieldType::kBeSigned: return w == 1 || w == 2 || w == 4 || w == 8;
+    case FieldType::kPacked:   return w >= 1 && w <= 9;
+    case FieldType::kZoned:    return w >= 1 && w <= 18;
+    default:                   return w >= 1;
+    }
+}
+
+/** outputWidth — Bytes a field occupies in the decoded row. */
+std::size_t outputWidth(const SchemaField& f) {
+    return f.type == FieldType::kPacked || f.type == FieldType::kZoned ? 8 : f.width;
+}
+
+std::size_t outputAlign(const SchemaField& f) {
+    return isText(f.type) ? 1 : outputWidth(f);
+}
+
+// decodeBatch as a permute mask: what a TxnRecord-shaped plan must compile to
+constexpr unsigned char kTxnRecordMask[16] = {3, 2, 1, 0, 7, 6, 5, 4,
+                                              9, 8, 11, 10, 12, 13, 14, 15};
+
+/**
+ * permute16 — out[j] = in[mask[j]] for one 16-byte window. GCC lowers the
+ * variable vector shuffle to pshufb where SSSE3 is available.
+ */
+[[gnu::always_inline]] inline void permute16(const char* in, const unsigned char* mask, char* out) {
+#if defined(__GNUC__) && !defined(__clang__)
+    typedef unsigned char Bytes16 __attribute__((vector_size(16)));
+    Bytes16 v, m;
+    std::memcpy(&v, in, 16);
+    std::memcpy(&m, mask, 16);
+    const Bytes16 r = __builtin_shuffle(v, m);
+    std::memcpy(out, &r, 16);
+#else
+    char r[16];
+    for (std::size_t j = 0; j < 16; ++j) r[j] = in[mask[j]];
+    std::memcpy(out, r, 16);
+#endif
+}
+
+/**
+ * runSteps — The step interpreter, row by row. Steps are in ascending
+ * output order, so the 16-byte store of a narrower permute only spills into
+ * bytes a later step (or the next row) overwrites.
+ */
+POS_TARGET_CLONES
+std::size_t runSteps(const DecodePlan::Step* steps, std::size_t nSteps, const char* raw,
+                     std::size_t recordLength, std::size_t count, char* out, std::size_t rowBytes) {
+    std::size_t bad = 0;
+    char window[16] = {};
+    for (std::size_t i = 0; i < count; ++i, raw += recordLength, out += rowBytes) {
+        for (std::size_t s = 0; s < nSteps; ++s) {
+            const DecodePlan::Step& st = steps[s];
+            switch (st.kind) {
+            case DecodePlan::StepKind::kPermute:
+                if (recordLength >= 16) {
+                    permute16(raw + st.src, st.mask, out + st.dst);
+                } else {
+                    std::memcpy(window, raw, recordLength);   // never load past the record
+                    permute16(window, st.mask, out + st.dst);
+                }
+                break;
+            case DecodePlan::StepKind::kCopy:
+                std::memcpy(out + st.dst, raw + st.src, st.width);
+                break;
+            case DecodePlan::StepKind::kTranslate:
+                ebcdicToLatin1(raw + st.src, st.width, out + st.dst);
+                break;
+            case DecodePlan::StepKind::kPacked: {
+                int64_t v;
+                if (!decodePacked(raw + st.src, st.width, v)) {
+                    v = 0;
+                    ++bad;
+                }
+                std::memcpy(out + st.dst, &v, sizeof(v));
+                break;
+            }
+            case DecodePlan::StepKind::kZoned:
+                break;      // whole column at once, after the row pass
+            }
+        }
+    }
+    return bad;
+}
+
+/** runPermute16 — A 16-byte record that is one permute: no interpreter. */
+POS_TARGET_CLONES
+void runPermute16(const unsigned char* mask, const char* raw, std::size_t count, char* out) {
+    for (std::size_t i = 0; i < count; ++i)
+        permute16(raw + i * 16, mask, out + i * 16);
+}
+
+}  // namespace
+
+bool parseSchema(const std::string& text, RecordSchema& schema, std::string& error) {
+    schema = RecordSchema{};
+    std::istringstream in(text);
+    std::string line;
+    for (std::size_t lineNo = 1; std::getline(in, line); ++lineNo) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string first;
+        if (!(words >> first)) continue;
+        const std::string where = "line " + std::to_string(lineNo) + ": ";
+
+        if (first == "record") {
+            if (!(words >> schema.recordLength) || schema.recordLength == 0) {
+                error = where + "expected 'record LENGTH'";
+                return false;
+            }
+            continue;
+        }
+        if (schema.recordLength == 0) {
+            error = where + "'record LENGTH' must come before the fields";
+            return false;
+        }
+        SchemaField f;
+        f.name = first;
+        std::string type;
+        if (!(words >> f.offset >> f.width >> type)) {
+            error = where + "expected 'NAME OFFSET WIDTH TYPE [SCALE]'";
+            return false;
+        }
+        words >> f.scale;
+        const TypeInfo* info = nullptr;
+        for (const TypeInfo& t : kTypes)
+            if (type == t.name) info = &t;
+        if (!info) {
+            error = where + "unknown type '" + type + "'";
+            return false;
+        }
+        f.type = info->type;
+        if (!widthAllowed(f.type, f.width)) {
+            error = where + "width " + std::to_string(f.width) + " is not valid for " + type;
+            return false;
+        }
+        if (f.offset + f.width > schema.recordLength) {
+            error = where + "field '" + f.name + "' ends past the record length";
+            return false;
+        }
+        schema.fields.push_back(std::move(f));
+    }
+    if (schema.fields.empty()) {
+        error = "schema has no fields";
+        return false;
+    }
+    return true;
+}
+
+bool loadSchema(const std::string& path, RecordSchema& schema, std::string& error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "cannot open " + path;
+        return false;
+    }
+    std::ostringstream text;
+    text << file.rdbuf();
+    if (!parseSchema(text.str(), schema, error)) {
+        error = path + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+DecodePlan DecodePlan::build(const RecordSchema& schema, bool allowSpecialized) {
+    DecodePlan plan;
+    plan.schema_ = schema;
+
+    // Output layout: fields in schema order, each aligned to its own width
+    std::size_t cursor = 0;
+    for (const SchemaField& f : schema.fields) {
+        const std::size_t align = outputAlign(f);
+        cursor = (cursor + align - 1) / align * align;
+        plan.outOffset_.push_back(cursor);
+        cursor += outputWidth(f);
+    }
+    plan.rowBytes_ = std::max<std::size_t>(8, (cursor + 7) / 8 * 8);
+
+    // Steps: extend the current one while the next field fuses into it
+    const std::size_t len = schema.recordLength;
+    for (std::size_t i = 0; i < schema.fields.size(); ++i) {
+        const SchemaField& f = schema.fields[i];
+        const uint32_t dst = static_cast<uint32_t>(plan.outOffset_[i]);
+        Step* cur = plan.steps_.empty() ? nullptr : &plan.steps_.back();
+        const bool outputAdjacent = cur && cur->dst + cur->width == dst;
+
+        if (isInteger(f.type) || (f.type == FieldType::kChar && f.width <= 16)) {
+            if (!(outputAdjacent && cur->kind == StepKind::kPermute && cur->width + f.width <= 16
+                  && f.offset >= cur->src && f.offset + f.width <= cur->src + 16)) {
+                plan.steps_.push_back(Step{StepKind::kPermute, static_cast<uint32_t>(f.offset),
+                                           dst, 0, 0, {}});
+                cur = &plan.steps_.back();
+            }
+            const bool reverse = isInteger(f.type) && std::endian::native == std::endian::little;
+            for (std::size_t k = 0; k < f.width; ++k)
+                cur->mask[cur->width + k] = static_cast<unsigned char>(
+                    f.offset - cur->src + (reverse ? f.width - 1 - k : k));
+            cur->width += static_cast<uint32_t>(f.width);
+            ++cur->fields;
+            continue;
+        }
+        if (isText(f.type)) {
+            const StepKind kind = f.type == FieldType::kEbcdic ? StepKind::kTranslate : StepKind::kCopy;
+            if (outputAdjacent && cur->kind == kind && cur->src + cur->width == f.offset) {
+                cur->width += static_cast<uint32_t>(f.width);
+                ++cur->fields;
+            } else {
+                plan.steps_.push_back(Step{kind, static_cast<uint32_t>(f.offset), dst,
+                                           static_cast<uint32_t>(f.width), 1, {}});
+            }
+            continue;
+        }
+        plan.steps_.push_back(Step{f.type == FieldType::kPacked ? StepKind::kPacked : StepKind::kZoned,
+                                   static_cast<uint32_t>(f.offset), dst,
+                                   static_cast<uint32_t>(f.width), 1, {}});
+    }
+
+    // Slide permute windows back inside the record; unused mask bytes take
+    // their own position (any in-window index would do)
+    for (Step& st : plan.steps_) {
+        if (st.kind != StepKind::kPermute) continue;
+        for (std::size_t j = 0; j < 16; ++j)
+            if (j >= st.width) st.mask[j] = static_cast<unsigned char>(j);
+        if (len < 16) {                            // runSteps loads the whole record
+            for (std::size_t j = 0; j < st.width; ++j) st.mask[j] += static_cast<unsigned char>(st.src);
+            st.src = 0;
+            continue;
+        }
+        const std::size_t shift = st.src + 16 > len ? st.src + 16 - len : 0;
+        st.src -= static_cast<uint32_t>(shift);
+        for (std::size_t j = 0; j < st.width; ++j) st.mask[j] += static_cast<unsigned char>(shift);
+    }
+
+    if (allowSpecialized && len == 16 && plan.rowBytes_ == 16 && plan.steps_.size() == 1
+        && plan.steps_[0].kind == StepKind::kPermute && plan.steps_[0].width == 16) {
+        plan.kernel_ = std::memcmp(plan.steps_[0].mask, kTxnRecordMask, 16) == 0 ? Kernel::kTxnRecord
+                                                                                 : Kernel::kPermute16;
+    }
+    return plan;
+}
+
+std::size_t DecodePlan::decode(const char* raw, std::size_t count, char* out) const {
+    switch (kernel_) {
+    case Kernel::kTxnRecord:
+        decodeBatch(raw, count, reinterpret_cast<TxnRecord*>(out));
+        return 0;
+    case Kernel::kPermute16:
+        runPermute16(steps_[0].mask, raw, count, out);
+        return 0;
+    default: {
+        std::size_t bad = runSteps(steps_.data(), steps_.size(), raw, schema_.recordLength, count,
+                                   out, rowBytes_);
+        for (const Step& st : steps_)
+            if (st.kind == StepKind::kZoned)
+                bad += decodeZonedBatch(raw + st.src, schema_.recordLength, st.width, count,
+                                        out + st.dst, rowBytes_);
+        return bad;
+    }
+    }
+}
+
+int64_t DecodePlan::integer(const char* row, std::size_t field) const {
+    const SchemaField& f = schema_.fields[field];
+    const char* p = row + outOffset_[field];
+    switch (outputWidth(f)) {
+    case 1: { uint8_t  v; std::memcpy(&v, p, 1); return f.type == FieldType::kBeSigned ? int8_t(v)  : int64_t{v}; }
+    case 2: { uint16_t v; std::memcpy(&v, p, 2); return f.type == FieldType::kBeSigned ? int16_t(v) : int64_t{v}; }
+    case 4: { uint32_t v; std::memcpy(&v, p, 4); return f.type == FieldType::kBeSigned ? int32_t(v) : int64_t{v}; }
+    default: { int64_t v; std::memcpy(&v, p, 8); return v; }
+    }
+}
+
+std::string_view DecodePlan::text(const char* row, std::size_t field) const {
+    return {row + outOffset_[field], schema_.fields[field].width};
+}
+
+std::string DecodePlan::shape() const {
+    if (kernel_ == Kernel::kTxnRecord) return "txn_record (decodeBatch, " + std::string(decodeKernelName()) + ")";
+    std::string out = kernel_ == Kernel::kPermute16 ? "permute16:" : "steps:";
+    static const char* const kNames[] = {"permute", "copy", "translate", "comp3", "zoned"};
+    for (const Step& st : steps_)
+        out += " " + std::string(kNames[static_cast<int>(st.kind)]) + "(" + std::to_string(st.fields)
+             + (st.fields == 1 ? " field, " : " fields, ") + std::to_string(st.width) + " B)";
+    return out;
+}
+
+std::vector<char> generateSchemaRecords(const RecordSchema& schema, std::size_t count) {
+    static const char* const kWords[] = {"VISA", "MC", "AMEX", "DISC", "DIESEL", "UNLEADED"};
+    std::vector<char> raw(count * schema.recordLength, 0);
+    for (std::size_t i = 0; i < count; ++i) {
+        char* rec = raw.data() + i * schema.recordLength;
+        for (std::size_t fi = 0; fi < schema.fields.size(); ++fi) {
+            const SchemaField& f = schema.fields[fi];
+            char* p = rec + f.offset;
+            const uint64_t seed = (i + 1) * (2 * fi + 1) * 7919;
+            switch (f.type) {
+            case FieldType::kBeUnsigned:
+            case FieldType::kBeSigned: {
+                const uint64_t v = f.type == FieldType::kBeSigned && i % 3 == 0 ? 0 - seed : seed;
+                switch (f.width) {
+                case 1:  storeBigEndian(p, static_cast<uint8_t>(v));  break;
+                case 2:  storeBigEndian(p, static_cast<uint16_t>(v)); break;
+                case 4:  storeBigEndian(p, static_cast<uint32_t>(v)); break;
+                default: storeBigEndian(p, v);                        break;
+                }
+                break;
+            }
+            case FieldType::kChar:
+            case FieldType::kEbcdic: {
+                std::string word = std::string(kWords[(i + fi) % 6]) + " " + std::to_string(i % 1000);
+                word.resize(f.width, ' ');
+                if (f.type == FieldType::kEbcdic) latin1ToEbcdic(word.data(), f.width, p);
+                else std::memcpy(p, word.data(), f.width);
+                break;
+            }
+            case FieldType::kPacked:
+            case FieldType::kZoned: {
+                const std::size_t digits = f.type == FieldType::kPacked ? 2 * f.width - 1 : f.width;
+                uint64_t limit = 1;
+                for (std::size_t d = 0; d < digits && d < 18; ++d) limit *= 10;
+                const int64_t v = static_cast<int64_t>(seed % limit) * (i % 5 == 0 ? -1 : 1);
+                if (f.type == FieldType::kPacked) encodePacked(v, f.width, p);
+                else encodeZoned(v, f.width, p);
+                break;
+            }
+            }
+        }
+    }
+    return raw;
+}
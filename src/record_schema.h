@@ -0,0 +1,136 @@
+// record_schema.h — Record layouts loaded at run time, and their decode plans
+//
+// TxnRecord and the multi-record payloads are compiled in. Partner exports
+// arrive in new fixed-length layouts often enough that recompiling for each
+// one is not practical, so a layout can instead be described in a text file:
+//
+//   # partner_a.schema — comments start with '#'
+//   record 40
+//   txnId        0  4  be_uint
+//   adjustment   4  4  be_int
+//   storeName    8 10  ebcdic
+//   amount      18  5  comp3   2      <- optional implied decimal places
+//   liters      23  7  zoned   3
+//   cardType    30  4  char
+//
+// Field types: be_uint / be_int (width 1, 2, 4 or 8), char (copied as is),
+// ebcdic (CP037 → Latin-1), comp3 (width 1–9) and zoned (width 1–18).
+//
+// Decoded rows are host-order records with a layout derived from the schema
+// (RecordSchema fields in order): integers keep their width, aligned to it,
+// text keeps its width, and decimals become int64. DecodePlan compiles the
+// schema into as few steps as it can:
+//
+//   permute    adjacent be_int/char fields whose bytes stay contiguous in the
+//              output, fused into one 16-byte shuffle mask (pshufb on
+//              x86-64-v2 and later)
+//   copy       long char runs
+//   translate  adjacent ebcdic fields, one table lookup per byte
+//   packed     one COMP-3 field
+//   zoned      one zoned field, decoded for the whole batch after the row
+//              steps by the SIMD decodeZonedBatch (ebcdic.h)
+//
+// and then recognizes known shapes: a layout identical to TxnRecord runs
+// decodeBatch itself, and any other 16-byte layout that fuses into a single
+// permute runs a dedicated loop instead of the step interpreter.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+enum class FieldType : uint8_t { kBeUnsigned, kBeSigned, kChar, kEbcdic, kPacked, kZoned };
+
+/** SchemaField — One field of the on-disk record. */
+struct SchemaField {
+    std::string name;
+    std::size_t offset = 0;
+    std::size_t width  = 0;
+    FieldType   type   = FieldType::kBeUnsigned;
+    unsigned    scale  = 0;     // implied decimal places (numeric fields)
+};
+
+/** RecordSchema — A fixed-length record layout. */
+struct RecordSchema {
+    std::size_t              recordLength = 0;
+    std::vector<SchemaField> fields;
+};
+
+/**
+ * parseSchema — Read the text format above; false (with `error` set, naming
+ * the line) on a syntax error, an unknown type, a width the type does not
+ * allow, or a field outside the record.
+ */
+bool parseSchema(const std::string& text, RecordSchema& schema, std::string& error);
+
+/** loadSchema — parseSchema of the file at `path`. */
+bool loadSchema(const std::string& path, RecordSchema& schema, std::string& error);
+
+/**
+ * DecodePlan — A schema compiled into decode steps (see above). Immutable
+ * once built; one plan can serve any number of threads.
+ */
+class DecodePlan {
+public:
+    /**
+     * build — Compile `schema` (validated by parseSchema). With
+     * `allowSpecialized` false the step interpreter is always used, which is
+     * what pos_bench compares against the hand-written decodeBatch.
+     */
+    static DecodePlan build(const RecordSchema& schema, bool allowSpecialized = true);
+
+    const RecordSchema& schema() const { return schema_; }
+
+    /** rowBytes — Size of one decoded row (a multiple of 8). */
+    std::size_t rowBytes() const { return rowBytes_; }
+
+    /**
+     * outputBytes — Buffer size decode() needs for `count` rows: the rows
+     * plus 16 bytes the vector stores may overrun.
+     */
+    std::size_t outputBytes(std::size_t count) const { return count * rowBytes_ + 16; }
+
+    /**
+     * decode — Decode `count` records from `raw` into rows at `out`
+     * (outputBytes(count) bytes). Returns the number of decimal fields that
+     * were not valid packed/zoned data; those decode as 0.
+     */
+    std::size_t decode(const char* raw, std::size_t count, char* out) const;
+
+    /** integer — Numeric field `field` of a decoded row (unscaled). */
+    int64_t integer(const char* row, std::size_t field) const;
+
+    /** text — char/ebcdic field `field` of a decoded row (Latin-1). */
+    std::string_view text(const char* row, std::size_t field) const;
+
+    /** shape — One line describing the chosen kernel and its steps. */
+    std::string shape() const;
+
+    enum class Kernel : uint8_t { kSteps, kTxnRecord, kPermute16 };
+    enum class StepKind : uint8_t { kPermute, kCopy, kTranslate, kPacked, kZoned };
+
+    struct Step {
+        StepKind      kind;
+        uint32_t      src;          // input offset (permute: of the 16-byte load)
+        uint32_t      dst;          // output offset
+        uint32_t      width;        // bytes consumed (permute: bytes produced)
+        uint32_t      fields;       // schema fields covered
+        unsigned char mask[16];     // permute: output byte j = load byte mask[j]
+    };
+
+private:
+    RecordSchema             schema_;
+    std::vector<Step>        steps_;
+    std::vector<std::size_t> outOffset_;   // per schema field
+    std::size_t              rowBytes_ = 0;
+    Kernel                   kernel_   = Kernel::kSteps;
+};
+
+/**
+ * generateSchemaRecords — `count` deterministic records in `schema`'s
+ * on-disk format (test data for pos_modern --schema and pos_bench).
+ */
+std::vector<char> generateSchemaRecords(const RecordSchema& schema, std::size_t count);
@@ -0,0 +1,131 @@
+// stage_profiler.h — Sampled per-record stage timeline
+//
+// Every Nth record carries a row of TSC timestamps, one per stage boundary,
+// through the pipeline. Recording a sample is a bounds check plus a few
+// stores into a preallocated buffer; all conversion, aggregation and JSON
+// formatting happens after the run.
+//
+// Output:
+//   - report(): mean time per stage and its share of the end-to-end total
+//   - writeChromeTrace(): Trace Event Format JSON, viewable in
+//     chrome://tracing or https://ui.perfetto.dev
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tsc_clock.h"
+
+/**
+ * StageProfiler — Fixed-capacity store of sampled stage timestamps.
+ *
+ * A sample for N stages has N+1 boundaries: stage s runs from
+ * boundaries[s] to boundaries[s+1].
+ */
+class StageProfiler {
+public:
+    StageProfiler(std::vector<std::string> stages, std::size_t capacity)
+        : stages_(std::move(stages)), stride_(stages_.size() + 1) {
+        ids_.reserve(capacity);
+        ticks_.reserve(capacity * stride_);
+        capacity_ = capacity;
+    }
+
+    /** sample — Store one record's boundaries; silently dropped when full. */
+    void sample(uint64_t id, const uint64_t* boundaries) noexcept {
+        if (ids_.size() == capacity_) {
+            ++dropped_;
+            return;
+        }
+        ids_.push_back(id);
+        ticks_.insert(ticks_.end(), boundaries, boundaries + stride_);
+    }
+
+    std::size_t samples() const { return ids_.size(); }
+
+    /** report — Mean ns per stage and its share of the sampled end-to-end time. */
+    void report(std::ostream& os, const TscClock& clock) const {
+        std::vector<uint64_t> totalTicks(stages_.size(), 0);
+        uint64_t endToEnd = 0;
+        for (std::size_t i = 0; i < ids_.size(); ++i) {
+            const uint64_t* b = &ticks_[i * stride_];
+            for (std::size_t s = 0; s < stages_.size(); ++s)
+                totalTicks[s] += b[s + 1] - b[s];
+            endToEnd += b[stages_.size()] - b[0];
+        }
+
+        const auto flags = os.flags();
+        const auto precision = os.precision();
+        os << "=== Stage breakdown (" << ids_.size() << " sampled records";
+        if (dropped_) os << ", " << dropped_ << " dropped";
+        os << ") ===\n"
+           << std::left  << std::setw(20) << "stage"
+           << std::right << std::setw(12) << "mean ns" << std::setw(10) << "share" << "\n"
+           << std::fixed << std::setprecision(1);
+        const double n = ids_.empty() ? 1.0 : static_cast<double>(ids_.size());
+        for (std::size_t s = 0; s < stages_.size(); ++s)
+            os << std::left  << std::setw(20) << stages_[s]
+               << std::right << std::setw(12) << static_cast<double>(clock.toNs(totalTicks[s])) / n
+               << std::setw(9)
+               << (endToEnd ? 100.0 * static_cast<double>(totalTicks[s]) / static_cast<double>(endToEnd) : 0.0)
+               << "%\n";
+        os.flags(flags);
+        os.precision(precision);
+    }
+
+    /**
+     * writeChromeTrace — One "record" span per sample with its stages nested
+     * inside. Samples that overlap in time (several per batch) are spread
+     * over separate rows so every row nests cleanly.
+     */
+    bool writeChromeTrace(const std::string& path, const TscClock& clock) const {
+        std::ofstream out(path);
+        if (!out) return false;
+
+        const uint64_t origin = ids_.empty() ? 0 : ticks_[0];
+        auto us = [&](uint64_t t) { return static_cast<double>(clock.toNs(t - origin)) / 1000.0; };
+
+        std::vector<uint64_t> laneEnd;   // last end tick per row
+        out << std::fixed << std::setprecision(3) << "{\"traceEvents\":[\n";
+        bool first = true;
+        auto event = [&](const std::string& name, uint64_t start, uint64_t end,
+                         std::size_t lane, uint64_t id) {
+            out << (first ? "" : ",\n")
+                << "{\"name\":\"" << name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << lane + 1
+                << ",\"ts\":" << us(start) << ",\"dur\":" << us(end) - us(start)
+                << ",\"args\":{\"record\":" << id << "}}";
+            first = false;
+        };
+
+        for (std::size_t i = 0; i < ids_.size(); ++i) {
+            const uint64_t* b = &ticks_[i * stride_];
+            const uint64_t start = b[0], end = b[stages_.size()];
+            std::size_t lane = 0;
+            while (lane < laneEnd.size() && laneEnd[lane] > start) ++lane;
+            if (lane == laneEnd.size()) laneEnd.push_back(0);
+            laneEnd[lane] = end;
+
+            event("record", start, end, lane, ids_[i]);
+            for (std::size_t s = 0; s < stages_.size(); ++s)
+                event(stages_[s], b[s], b[s + 1], lane, ids_[i]);
+        }
+        out << "\n],\"displayTimeUnit\":\"ns\"}\n";
+        return static_cast<bool>(out);
+    }
+
+private:
+    std::vector<std::string> stages_;
+    std::size_t stride_;
+    std::size_t capacity_ = 0;
+    std::size_t dropped_  = 0;
+    std::vector<uint64_t> ids_;
+    std::vector<uint64_t> ticks_;
+};
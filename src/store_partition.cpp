@@ -0,0 +1,207 @@
+// store_partition.cpp — Radix partition by store and the per-store file writer
+
+#include "store_partition.h"
+
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+using Histogram = std::array<std::size_t, 256>;
+
+/** scatter — Stable counting-sort pass of `in` into `out` on the byte at `shift`. */
+void scatter(const TxnRecord* __restrict in, std::size_t count, TxnRecord* __restrict out,
+             const Histogram& counts, unsigned shift) {
+    Histogram next;
+    std::size_t at = 0;
+    for (std::size_t b = 0; b < 256; ++b) {
+        next[b] = at;
+        at += counts[b];
+    }
+    for (std::size_t i = 0; i < count; ++i)
+        out[next[(in[i].storeNumber >> shift) & 0xFF]++] = in[i];
+}
+
+/** heapBytes — Memory `buffer` holds beyond its inline (small-string) storage. */
+std::size_t heapBytes(const std::string& buffer) {
+    return buffer.capacity() > std::string().capacity() ? buffer.capacity() : 0;
+}
+
+}  // namespace
+
+void partitionByStore(const TxnRecord* txns, std::size_t count, StorePartition& out) {
+    out.records.resize(count);
+    out.runs.clear();
+    if (count == 0) return;
+
+    Histogram low{}, high{};
+    for (std::size_t i = 0; i < count; ++i) {
+        ++low[txns[i].storeNumber & 0xFF];
+        ++high[txns[i].storeNumber >> 8];
+    }
+    if (high[txns[0].storeNumber >> 8] == count) {
+        scatter(txns, count, out.records.data(), low, 0);   // one high byte: one pass
+    } else {
+        out.scratch.resize(count);
+        scatter(txns, count, out.scratch.data(), low, 0);
+        scatter(out.scratch.data(), count, out.records.data(), high, 8);
+    }
+
+    std::size_t begin = 0;
+    for (std::size_t i = 1; i <= count; ++i) {
+        if (i == count || out.records[i].storeNumber != out.records[begin].storeNumber) {
+            out.runs.push_back(StoreRun{out.records[begin].storeNumber, begin, i - begin});
+            begin = i;
+        }
+    }
+}
+
+// ---------------------------------------------------------------------------
+// StoreFileWriter
+// ---------------------------------------------------------------------------
+
+StoreFileWriter::StoreFileWriter(std::string dir, StoreFileFormat format, std::size_t maxOpenFiles)
+    : dir_(std::move(dir)), format_(format), maxOpen_(std::max<std::size_t>(1, maxOpenFiles)) {
+    if (::mkdir(dir_.c_str(), 0755) != 0 && errno != EEXIST)
+        error_ = "cannot create " + dir_ + ": " + std::strerror(errno);
+}
+
+StoreFileWriter::~StoreFileWriter() { finish(); }
+
+std::string StoreFileWriter::path(uint16_t store) const {
+    char name[32];
+    std::snprintf(name, sizeof(name), "/store-%05u.%s", static_cast<unsigned>(store),
+                  format_ == StoreFileFormat::kCsv ? "csv" : format_ == StoreFileFormat::kNdjson ? "ndjson" : "bin");
+    return dir_ + name;
+}
+
+bool StoreFileWriter::append(uint16_t store, const TxnRecord* txns, std::size_t count) {
+    if (!ok()) return false;
+    Store& s = stores_[store];
+    if (!s.active) {
+        s.active = true;
+        active_.push_back(store);
+    }
+    const std::size_t before = heapBytes(s.buffer);
+    if (!s.created && s.buffer.empty() && format_ == StoreFileFormat::kCsv)
+        s.buffer.append(CsvFormat::kHeader);
+    switch (format_) {
+    case StoreFileFormat::kRaw:
+        s.buffer.append(reinterpret_cast<const char*>(txns), count * sizeof(TxnRecord));
+        break;
+    case StoreFileFormat::kCsv:
+        formatRows<CsvFormat>(txns, count, s.buffer);
+        break;
+    case StoreFileFormat::kNdjson:
+        formatRows<NdjsonFormat>(txns, count, s.buffer);
+        break;
+    }
+    held_ += heapBytes(s.buffer) - before;
+    if (s.buffer.size() >= kFlushBytes && !flush(store)) return false;
+    return held_ <= kBufferBudget || flushLargest();
+}
+
+bool StoreFileWriter::append(const StorePartition& part) {
+    for (const StoreRun& run : part.runs)
+        if (!append(run.store, part.records.data() + run.begin, run.count)) return false;
+    return true;
+}
+
+/**
+ * flushLargest — Over budget: write the largest buffers and release their
+ * memory until half the budget is left. A buffer that was just written is
+ * empty but keeps its capacity, so it is sized by capacity, not contents;
+ * otherwise every store that once reached kFlushBytes would keep that
+ * much memory for the rest of the run.
+ */
+bool StoreFileWriter::flushLargest() {
+    std::sort(active_.begin(), active_.end(), [&](uint16_t a, uint16_t b) {
+        return heapBytes(stores_[a].buffer) > heapBytes(stores_[b].buffer);
+    });
+    for (uint16_t store : active_) {
+        if (held_ <= kBufferBudget / 2) break;
+        if (!flush(store)) return false;
+        held_ -= heapBytes(stores_[store].buffer);
+        std::string().swap(stores_[store].buffer);
+    }
+    std::erase_if(active_, [&](uint16_t store) {
+        if (heapBytes(stores_[store].buffer) != 0) return false;
+        stores_[store].active = false;
+        return true;
+    });
+    return true;
+}
+
+/** descriptor — The open file of `store`, opening it (and closing the LRU file) if needed. */
+int StoreFileWriter::descriptor(uint16_t store) {
+    Store& s = stores_[store];
+    if (s.fd >= 0) {
+        lru_.splice(lru_.begin(), lru_, s.lru);
+        return s.fd;
+    }
+    if (lru_.size() >= maxOpen_) {
+        Store& victim = stores_[lru_.back()];
+        ::close(victim.fd);
+        victim.fd = -1;
+        lru_.pop_back();
+        ++evictions_;
+    }
+    const std::string file = path(store);
+    s.fd = ::open(file.c_str(), O_WRONLY | O_CREAT | O_CLOEXEC | (s.created ? O_APPEND : O_TRUNC), 0644);
+    if (s.fd < 0) {
+        error_ = "cannot open " + file + ": " + std::strerror(errno);
+        return -1;
+    }
+    if (!s.created) {
+        s.created = true;
+        ++files_;
+    }
+    ++opens_;
+    lru_.push_front(store);
+    s.lru = lru_.begin();
+    return s.fd;
+}
+
+bool StoreFileWriter::flush(uint16_t store) {
+    Store& s = stores_[store];
+    if (s.buffer.empty()) return ok();
+    const int fd = descriptor(store);
+    if (fd < 0) return false;
+    const char* p = s.buffer.data();
+    std::size_t left = s.buffer.size();
+    while (left > 0) {
+        const ssize_t n = ::write(fd, p, left);
+        ++writes_;
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            error_ = "write failed: " + path(store) + ": " + std::strerror(errno);
+            return false;
+        }
+        p += n;
+        left -= static_cast<std::size_t>(n);
+    }
+    bytes_ += s.buffer.size();
+    s.buffer.clear();
+    return true;
+}
+
+bool StoreFileWriter::finish() {
+    for (uint16_t store : active_) {
+        if (ok()) flush(store);
+        stores_[store].active = false;
+    }
+    active_.clear();
+    for (uint16_t store : lru_) {
+        ::close(stores_[store].fd);
+        stores_[store].fd = -1;
+    }
+    lru_.clear();
+    return ok();
+}
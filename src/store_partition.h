@@ -0,0 +1,121 @@
+// store_partition.h — Decoded TxnRecords fanned out to one file per store
+//
+// Regional teams take their stores' transactions as separate files, one
+// per storeNumber. Writing each record where it belongs as it arrives would
+// turn the export into random small writes across thousands of files, so
+// the fan-out happens in two steps:
+//
+//   partitionByStore   each thread groups its own batch by store with a
+//                      stable radix partition (two 8-bit passes, 256
+//                      buckets each; one pass when every store shares its
+//                      high byte). Each store's records end up in one
+//                      contiguous run, in input order.
+//   StoreFileWriter    the runs are appended, in batch order, to one
+//                      buffer per store. A buffer is written once it holds
+//                      kFlushBytes, so each file grows in large
+//                      sequential chunks. The memory the buffers hold
+//                      (their capacity, which a write does not give back)
+//                      is kept under a budget: when it is exceeded the
+//                      largest are written and released first. At most `maxOpenFiles`
+//                      descriptors are open: the least recently written
+//                      file is closed to make room, and reopened later in
+//                      append mode.
+//
+// Files are DIR/store-NNNNN.{bin,csv,ndjson}: raw 16-byte host-order
+// records as with --binary, or the rows of text_format.h, with the CSV
+// header once per file.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <string>
+#include <vector>
+
+#include "text_format.h"
+#include "txn_record.h"
+
+/** StoreRun — `count` consecutive records of one store in a StorePartition. */
+struct StoreRun {
+    uint16_t    store;
+    std::size_t begin;
+    std::size_t count;
+};
+
+/** StorePartition — One batch grouped by store; reused across batches. */
+struct StorePartition {
+    std::vector<TxnRecord> records;   // grouped by store, ascending; input order within a store
+    std::vector<TxnRecord> scratch;   // the first pass's output
+    std::vector<StoreRun>  runs;
+};
+
+/** partitionByStore — Group `count` records at `txns` by storeNumber into `out`. */
+void partitionByStore(const TxnRecord* txns, std::size_t count, StorePartition& out);
+
+enum class StoreFileFormat : uint8_t { kRaw, kCsv, kNdjson };
+
+/**
+ * StoreFileWriter — Buffered per-store files under one directory, with a
+ * bounded number of open descriptors. Not thread-safe: one thread appends
+ * in output order.
+ */
+class StoreFileWriter {
+public:
+    static constexpr std::size_t kFlushBytes   = std::size_t{256} << 10;   // per write
+    static constexpr std::size_t kBufferBudget = std::size_t{64} << 20;    // all buffers
+
+    /** Creates `dir` if needed; check ok(). */
+    StoreFileWriter(std::string dir, StoreFileFormat format, std::size_t maxOpenFiles);
+    ~StoreFileWriter();
+
+    StoreFileWriter(const StoreFileWriter&) = delete;
+    StoreFileWriter& operator=(const StoreFileWriter&) = delete;
+
+    /** append — Add `count` records of `store` to its file; false after an error. */
+    bool append(uint16_t store, const TxnRecord* txns, std::size_t count);
+
+    /** append — Every run of `part`. */
+    bool append(const StorePartition& part);
+
+    /** finish — Write every buffer and close every file; false after an error. */
+    bool finish();
+
+    bool               ok() const           { return error_.empty(); }
+    const std::string& error() const        { return error_; }
+    std::size_t        files() const        { return files_; }
+    uint64_t           bytesWritten() const { return bytes_; }
+    uint64_t           writes() const       { return writes_; }
+    uint64_t           opens() const        { return opens_; }
+    uint64_t           evictions() const    { return evictions_; }
+
+    /** path — The file of `store`. */
+    std::string path(uint16_t store) const;
+
+private:
+    struct Store {
+        std::string                    buffer;
+        int                            fd      = -1;
+        bool                           created = false;
+        bool                           active  = false;   // listed in active_
+        std::list<uint16_t>::iterator  lru;               // valid while fd >= 0
+    };
+
+    bool flush(uint16_t store);
+    bool flushLargest();
+    int  descriptor(uint16_t store);
+
+    std::string           dir_;
+    StoreFileFormat       format_;
+    std::size_t           maxOpen_;
+    std::vector<Store>    stores_ = std::vector<Store>(65536);
+    std::vector<uint16_t> active_;        // stores whose buffer holds memory
+    std::list<uint16_t>   lru_;           // open files, most recently written first
+    std::size_t           held_      = 0; // capacity of every buffer
+    std::size_t           files_     = 0;
+    uint64_t              bytes_     = 0;
+    uint64_t              writes_    = 0;
+    uint64_t              opens_     = 0;
+    uint64_t              evictions_ = 0;
+    std::string           error_;
+};
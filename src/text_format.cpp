@@ -0,0 +1,36 @@
+// text_format.cpp — Out-of-line slow paths of the CSV / NDJSON formats
+//
+// Only card types with quotes, commas, backslashes, control characters or
+// (JSON) bytes outside ASCII come here; generated and well-formed exports
+// never do.
+
+#include "text_format.h"
+
+char* writeCsvCardQuoted(char* p, const char* card, std::size_t n) {
+    *p++ = '"';
+    for (std::size_t k = 0; k < n; ++k) {
+        if (card[k] == '"') *p++ = '"';
+        *p++ = card[k];
+    }
+    *p++ = '"';
+    return p;
+}
+
+char* writeJsonCardEscaped(char* p, const char* card, std::size_t n) {
+    static const char kHex[] = "0123456789abcdef";
+    for (std::size_t k = 0; k < n; ++k) {
+        const auto c = static_cast<unsigned char>(card[k]);
+        if (c == '"' || c == '\\') {
+            *p++ = '\\';
+            *p++ = static_cast<char>(c);
+        } else if (c < 0x20 || c >= 0x7F) {
+            // Latin-1 byte as its code point
+            p = writeLiteral(p, "\\u00");
+            *p++ = kHex[c >> 4];
+            *p++ = kHex[c & 0xF];
+        } else {
+            *p++ = static_cast<char>(c);
+        }
+    }
+    return p;
+}
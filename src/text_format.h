@@ -0,0 +1,239 @@
+// text_format.h — CSV and NDJSON rows for decoded TxnRecords
+//
+// Downstream loaders take delimited text rather than the processTxn layout:
+//
+//   CSV     txnId,amount,storeNumber,pumpNumber,cardType
+//           1,50.00,100,7,VISA
+//   NDJSON  {"txnId":1,"amount":50.00,"storeNumber":100,"pumpNumber":7,"cardType":"VISA"}
+//
+// amount is written in dollars with exactly two decimals (no floating point)
+// and cardType without its trailing blanks. Card types that need it are
+// quoted (CSV) or escaped (JSON, bytes above 0x7E as \u00XX Latin-1).
+//
+// The format is a template parameter (CsvFormat / NdjsonFormat), so each
+// row loop is compiled for its format and nothing is dispatched per record;
+// the TextFormat overload of formatRows switches once per batch.
+//
+// Integers are converted eight digits at a time in one 64-bit register
+// (encodeDigits8: two divide-by-constant steps done as multiplies, across
+// all lanes at once) and stored with unaligned 8-byte writes, so rows are
+// built without a per-digit loop, a division per digit or a branch per
+// digit count. Rows are written into space reserved for the worst case and
+// the string is trimmed once per batch.
+
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <string_view>
+
+#include "txn_record.h"
+
+// ---------------------------------------------------------------------------
+// Integer → decimal
+// ---------------------------------------------------------------------------
+
+/** storeDigits8 — 8 bytes at `p`, byte 0 from the low end of `v` (any host). */
+inline void storeDigits8(char* p, uint64_t v) {
+    if constexpr (std::endian::native == std::endian::big) v = byteswapPortable(v);
+    std::memcpy(p, &v, 8);
+}
+
+/**
+ * encodeDigits8 — The 8 ASCII digits of `v` < 10^8, zero-padded, most
+ * significant first in byte 0: the value splits into 4-digit halves in two
+ * 32-bit lanes, each into 2-digit pairs in 16-bit lanes, each into digits —
+ * every split one multiply-shift for all lanes together.
+ */
+constexpr uint64_t encodeDigits8(uint32_t v) {
+    const uint64_t merged = (v / 10000) | uint64_t{v % 10000} << 32;
+    const uint64_t hundreds = ((merged * 10486) >> 20) & 0x0000007F0000007FULL;   // / 100
+    const uint64_t pairs = ((merged - 100 * hundreds) << 16) + hundreds;
+    const uint64_t tens = ((pairs * 103) >> 10) & 0x000F000F000F000FULL;          // / 10
+    return tens + ((pairs - 10 * tens) << 8) + 0x3030303030303030ULL;
+}
+
+/**
+ * kDecimalLengthTable — Entry b = (d + 1)·2^32 − 10^d, d = digits of 2^b:
+ * adding v of bit length b + 1 carries into the high word exactly when
+ * v >= 10^d (d = 10: no carry possible).
+ */
+inline constexpr uint64_t kDecimalLengthTable[32] = {
+    8589934582,  8589934582,  8589934582,  8589934582,  12884901788, 12884901788,
+    12884901788, 17179868184, 17179868184, 17179868184, 21474826480, 21474826480,
+    21474826480, 21474826480, 25769703776, 25769703776, 25769703776, 30063771072,
+    30063771072, 30063771072, 34349738368, 34349738368, 34349738368, 34349738368,
+    38554705664, 38554705664, 38554705664, 41949672960, 41949672960, 41949672960,
+    42949672960, 42949672960};
+
+/** decimalLength — Digits in `v` (1 for 0), from its bit length. */
+constexpr unsigned decimalLength(uint32_t v) {
+    return static_cast<unsigned>((v + kDecimalLengthTable[31 - std::countl_zero(v | 1)]) >> 32);
+}
+
+static_assert(encodeDigits8(12345678) == 0x3837363534333231ULL, "encodeDigits8 digit order");
+static_assert(decimalLength(0) == 1 && decimalLength(9) == 1 && decimalLength(10) == 2
+              && decimalLength(99999999) == 8 && decimalLength(100000000) == 9
+              && decimalLength(4294967295u) == 10, "decimalLength");
+
+/**
+ * writeUint — `v` in decimal at `p`; returns the end. May store up to 8
+ * bytes past the end (callers reserve kMaxRow per row).
+ */
+inline char* writeUint(char* p, uint32_t v) {
+    if (v < 100000000) {
+        const unsigned n = decimalLength(v);
+        storeDigits8(p, encodeDigits8(v) >> (8 * (8 - n)));
+        return p + n;
+    }
+    const uint32_t high = v / 100000000;                    // 1–42
+    if (high >= 10) *p++ = static_cast<char>('0' + high / 10);
+    *p++ = static_cast<char>('0' + high % 10);
+    storeDigits8(p, encodeDigits8(v % 100000000));
+    return p + 8;
+}
+
+/** writeCents — `cents` as dollars with two decimals ("50.00"). */
+inline char* writeCents(char* p, uint32_t cents) {
+    p = writeUint(p, cents / 100);
+    const uint32_t c = cents % 100;
+    p[0] = '.';
+    p[1] = static_cast<char>('0' + c / 10);
+    p[2] = static_cast<char>('0' + c % 10);
+    return p + 3;
+}
+
+/** writeLiteral — Copy a compile-time string (no terminator). */
+template <std::size_t N>
+inline char* writeLiteral(char* p, const char (&s)[N]) {
+    std::memcpy(p, s, N - 1);
+    return p + N - 1;
+}
+
+/** cardLength — cardType without trailing blanks. */
+inline std::size_t cardLength(const char (&card)[4]) {
+    std::size_t n = 4;
+    while (n > 0 && card[n - 1] == ' ') --n;
+    return n;
+}
+
+/**
+ * writeCsvCardQuoted / writeJsonCardEscaped — Slow paths for the `n`-byte
+ * card types the row loops cannot copy as is.
+ */
+char* writeCsvCardQuoted(char* p, const char* card, std::size_t n);
+char* writeJsonCardEscaped(char* p, const char* card, std::size_t n);
+
+// ---------------------------------------------------------------------------
+// Formats
+// ---------------------------------------------------------------------------
+
+/** CsvFormat — RFC 4180 rows with a header line. */
+struct CsvFormat {
+    static constexpr std::string_view kHeader = "txnId,amount,storeNumber,pumpNumber,cardType\n";
+    static constexpr std::size_t      kMaxRow = 64;
+
+    static char* row(char* p, const TxnRecord& txn) {
+        p = writeUint(p, txn.txnId);
+        *p++ = ',';
+        p = writeCents(p, txn.amountCents);
+        *p++ = ',';
+        p = writeUint(p, txn.storeNumber);
+        *p++ = ',';
+        p = writeUint(p, txn.pumpNumber);
+        *p++ = ',';
+        const std::size_t n = cardLength(txn.cardType);
+        bool plain = true;
+        for (std::size_t k = 0; k < n; ++k) {
+            const auto c = static_cast<unsigned char>(txn.cardType[k]);
+            plain &= c >= 0x20 && c != ',' && c != '"' && c != 0x7F;
+        }
+        if (plain) {
+            std::memcpy(p, txn.cardType, 4);
+            p += n;
+        } else {
+            p = writeCsvCardQuoted(p, txn.cardType, n);
+        }
+        *p++ = '\n';
+        return p;
+    }
+};
+
+/** NdjsonFormat — One JSON object per line. */
+struct NdjsonFormat {
+    static constexpr std::string_view kHeader = "";
+    static constexpr std::size_t      kMaxRow = 128;
+
+    static char* row(char* p, const TxnRecord& txn) {
+        p = writeLiteral(p, "{\"txnId\":");
+        p = writeUint(p, txn.txnId);
+        p = writeLiteral(p, ",\"amount\":");
+        p = writeCents(p, txn.amountCents);
+        p = writeLiteral(p, ",\"storeNumber\":");
+        p = writeUint(p, txn.storeNumber);
+        p = writeLiteral(p, ",\"pumpNumber\":");
+        p = writeUint(p, txn.pumpNumber);
+        p = writeLiteral(p, ",\"cardType\":\"");
+        const std::size_t n = cardLength(txn.cardType);
+        bool plain = true;
+        for (std::size_t k = 0; k < n; ++k) {
+            const auto c = static_cast<unsigned char>(txn.cardType[k]);
+            plain &= c >= 0x20 && c < 0x7F && c != '"' && c != '\\';
+        }
+        if (plain) {
+            std::memcpy(p, txn.cardType, 4);
+            p += n;
+        } else {
+            p = writeJsonCardEscaped(p, txn.cardType, n);
+        }
+        return writeLiteral(p, "\"}\n");
+    }
+};
+
+/**
+ * formatRows — `count` rows in Format (no header) at `out`, which has room
+ * for count * Format::kMaxRow bytes; returns the end.
+ */
+template <typename Format>
+char* formatRows(const TxnRecord* txns, std::size_t count, char* out) {
+    for (std::size_t i = 0; i < count; ++i) out = Format::row(out, txns[i]);
+    return out;
+}
+
+/** formatRows — Append `count` rows in Format (no header) to `out`. */
+template <typename Format>
+void formatRows(const TxnRecord* txns, std::size_t count, std::string& out) {
+    const std::size_t at = out.size();
+    out.resize(at + count * Format::kMaxRow);
+    char* const begin = out.data() + at;
+    const char* end = formatRows<Format>(txns, count, begin);
+    out.resize(at + static_cast<std::size_t>(end - begin));
+}
+
+enum class TextFormat : uint8_t { kCsv, kNdjson };
+
+/** formatRows — The run-time choice, made once per batch. */
+inline void formatRows(TextFormat format, const TxnRecord* txns, std::size_t count, std::string& out) {
+    if (format == TextFormat::kCsv)
+        formatRows<CsvFormat>(txns, count, out);
+    else
+        formatRows<NdjsonFormat>(txns, count, out);
+}
+
+inline char* formatRows(TextFormat format, const TxnRecord* txns, std::size_t count, char* out) {
+    return format == TextFormat::kCsv ? formatRows<CsvFormat>(txns, count, out)
+                                      : formatRows<NdjsonFormat>(txns, count, out);
+}
+
+/** maxRowBytes — Room one row of `format` may need (Format::kMaxRow). */
+inline std::size_t maxRowBytes(TextFormat format) {
+    return format == TextFormat::kCsv ? CsvFormat::kMaxRow : NdjsonFormat::kMaxRow;
+}
+
+/** textHeader — What precedes the first row (the CSV header line). */
+inline std::string_view textHeader(TextFormat format) {
+    return format == TextFormat::kCsv ? CsvFormat::kHeader : NdjsonFormat::kHeader;
+}
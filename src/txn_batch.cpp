@@ -0,0 +1,166 @@
+// txn_batch.cpp — Multi-versioned batch kernels (see multiversion.h)
+//
+// These three loops dominate the pipeline's CPU time, so they are compiled
+// once per x86-64 ISA level and bound to the best one at load time:
+//
+//   decodeBatch     hand-picked bodies: the field-by-field bswap loop for
+//                   the baseline, and a constant byte shuffle for v2+ that
+//                   compiles to one pshufb/vpshufb per record (per 2 or 4
+//                   records with AVX2/AVX-512).
+//   decodeColumns   one body, target_clones — strided loads, swapped and
+//                   stored per column
+//   filterBatch     one body, target_clones — branch-free compaction
+//   aggregateBatch  one body, target_clones — vectorized validation
+//   convertHfp*     one body each, target_clones — byte swap, magic-number
+//                   int → double and exponent scaling, all lane-wise
+
+#include "txn_batch.h"
+
+#include "multiversion.h"
+#include "usdt.h"
+
+namespace {
+
+/** decodeBswap — Field-wise swap; the fastest form without pshufb. */
+[[gnu::always_inline]] inline void decodeBswap(const char* raw, std::size_t count,
+                                               TxnRecord* out) {
+    std::memcpy(out, raw, count * sizeof(TxnRecord));
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i].txnId       = fromBigEndian32(out[i].txnId);
+        out[i].amountCents = fromBigEndian32(out[i].amountCents);
+        out[i].storeNumber = fromBigEndian16(out[i].storeNumber);
+        out[i].pumpNumber  = fromBigEndian16(out[i].pumpNumber);
+    }
+}
+
+/**
+ * decodeShuffle — The whole 16-byte record as one constant byte permutation:
+ * reverse bytes 0–3 and 4–7 (txnId, amountCents), 8–9 and 10–11 (store,
+ * pump), keep 12–15 (cardType). Only valid on Little-Endian hosts, which is
+ * every host the v2+ versions can run on.
+ */
+[[gnu::always_inline]] inline void decodeShuffle(const char* __restrict raw, std::size_t count,
+                                                 TxnRecord* __restrict out) {
+    static constexpr unsigned char kPerm[16] = {3, 2, 1, 0, 7, 6, 5, 4,
+                                                9, 8, 11, 10, 12, 13, 14, 15};
+    const auto* in  = reinterpret_cast<const unsigned char*>(raw);
+    auto*       dst = reinterpret_cast<unsigned char*>(out);
+    for (std::size_t i = 0; i < count; ++i)
+        for (std::size_t j = 0; j < 16; ++j)
+            dst[i * 16 + j] = in[i * 16 + kPerm[j]];
+}
+
+// Per-level versions; callers go through the ifunc-dispatched symbol.
+POS_TARGET("default")
+void decodeImpl(const char* raw, std::size_t count, TxnRecord* out) {
+    decodeBswap(raw, count, out);
+}
+
+#if defined(POS_HAVE_MULTIVERSION)
+POS_TARGET("arch=x86-64-v2")
+void decodeImpl(const char* raw, std::size_t count, TxnRecord* out) {
+    decodeShuffle(raw, count, out);
+}
+
+POS_TARGET("arch=x86-64-v3")
+void decodeImpl(const char* raw, std::size_t count, TxnRecord* out) {
+    decodeShuffle(raw, count, out);
+}
+
+POS_TARGET("arch=x86-64-v4")
+void decodeImpl(const char* raw, std::size_t count, TxnRecord* out) {
+    decodeShuffle(raw, count, out);
+}
+#endif
+
+#if defined(POS_HAVE_USDT)
+/**
+ * probeRejects — Fire validate__reject for each invalid record. A probe is
+ * an asm statement the vectorizer cannot move, so it stays out of the
+ * cloned loop; this scalar pass runs only for batches with rejects.
+ */
+[[gnu::cold, gnu::noinline]] void probeRejects(const TxnRecord* txns, std::size_t count) {
+    for (std::size_t i = 0; i < count; ++i)
+        if (!validateTxn(txns[i])) POS_PROBE2(validate__reject, txns[i].txnId, txns[i].storeNumber);
+}
+#endif
+
+} // namespace
+
+void decodeBatch(const char* raw, std::size_t count, TxnRecord* out) {
+    decodeImpl(raw, count, out);
+}
+
+const char* decodeKernelName() {
+#if defined(POS_HAVE_MULTIVERSION)
+    static const std::string name = [] {
+        const std::string level = multiversionLevel();
+        return (level == "default" ? "bswap/" : "shuffle/") + level;
+    }();
+    return name.c_str();
+#else
+    return "bswap/default";
+#endif
+}
+
+POS_TARGET_CLONES
+void decodeColumns(const char* __restrict raw, std::size_t count, const TxnColumnsView& out) {
+    uint32_t* __restrict txnId  = out.txnId;
+    uint32_t* __restrict amount = out.amountCents;
+    uint16_t* __restrict store  = out.storeNumber;
+    uint16_t* __restrict pump   = out.pumpNumber;
+    char*     __restrict card   = out.cardType;
+    for (std::size_t i = 0; i < count; ++i) {
+        const char* rec = raw + i * sizeof(TxnRecord);
+        txnId[i]  = loadBigEndian<uint32_t>(rec);
+        amount[i] = loadBigEndian<uint32_t>(rec + 4);
+        store[i]  = loadBigEndian<uint16_t>(rec + 8);
+        pump[i]   = loadBigEndian<uint16_t>(rec + 10);
+        std::memcpy(card + i * 4, rec + 12, 4);
+    }
+}
+
+POS_TARGET_CLONES
+std::size_t filterBatch(const TxnRecord* in, std::size_t count, const TxnFilter& filter,
+                        TxnRecord* out) {
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        const TxnRecord& txn = in[i];
+        const bool pass = (txn.amountCents >= filter.minAmountCents)
+                        & (txn.amountCents <= filter.maxAmountCents)
+                        & (txn.storeNumber >= filter.minStore)
+                        & (txn.storeNumber <= filter.maxStore);
+        out[kept] = txn;          // unconditional store, conditional advance
+        kept += pass;
+    }
+    return kept;
+}
+
+POS_TARGET_CLONES
+std::size_t aggregateBatch(const TxnRecord* txns, std::size_t count, StoreTotals& totals) {
+    std::size_t rejects = 0;
+    for (std::size_t i = 0; i < count; ++i) {
+        if (validateTxn(txns[i]))
+            totals.add(txns[i]);
+        else
+            ++rejects;
+    }
+#if defined(POS_HAVE_USDT)
+    if (rejects) probeRejects(txns, count);
+#endif
+    return rejects;
+}
+
+POS_TARGET_CLONES
+void convertHfp32Batch(const char* raw, std::size_t count, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = fromIbmHfp32(loadBigEndian<uint32_t>(raw + i * 4));
+    }
+}
+
+POS_TARGET_CLONES
+void convertHfp64Batch(const char* raw, std::size_t count, double* out) {
+    for (std::size_t i = 0; i < count; ++i) {
+        out[i] = fromIbmHfp64(loadBigEndian<uint64_t>(raw + i * 8));
+    }
+}
@@ -0,0 +1,176 @@
+// txn_batch.h — Batch kernels of the record pipeline
+//
+// The per-record steps of processTxn, restated over whole batches so the
+// compiler can keep them in tight loops: encode/generate (test data),
+// decode, validate, filter, aggregate (StoreTotals), and text formatting.
+//
+// decodeBatch, decodeColumns, filterBatch, aggregateBatch and the HFP
+// converters are defined out of line in txn_batch.cpp, where they are
+// multi-versioned per x86-64 ISA level (see multiversion.h); everything else
+// is inline.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "txn_record.h"
+
+/**
+ * encodeTxn — Write a TxnRecord in the OS/400 on-disk (Big-Endian) format.
+ * A byte swap is its own inverse, so the decode helpers also encode.
+ */
+inline void encodeTxn(const TxnRecord& txn, char* out) {
+    TxnRecord be = txn;
+    be.txnId       = fromBigEndian32(txn.txnId);
+    be.amountCents = fromBigEndian32(txn.amountCents);
+    be.storeNumber = fromBigEndian16(txn.storeNumber);
+    be.pumpNumber  = fromBigEndian16(txn.pumpNumber);
+    std::memcpy(out, &be, sizeof(TxnRecord));
+}
+
+/**
+ * generateExport — Build `count` deterministic Big-Endian records, standing
+ * in for an iSeries flat-file export.
+ */
+inline std::vector<char> generateExport(std::size_t count) {
+    static const char cards[4][4] = {{'V','I','S','A'}, {'M','C',' ',' '},
+                                     {'A','M','E','X'}, {'D','I','S','C'}};
+    std::vector<char> raw(count * sizeof(TxnRecord));
+    for (std::size_t i = 0; i < count; ++i) {
+        TxnRecord txn;
+        txn.txnId       = static_cast<uint32_t>(i + 1);
+        txn.amountCents = static_cast<uint32_t>((i * 7919) % 100000);
+        txn.storeNumber = static_cast<uint16_t>(100 + i % 50);
+        txn.pumpNumber  = static_cast<uint16_t>(1 + i % 12);
+        std::memcpy(txn.cardType, cards[i % 4], sizeof(txn.cardType));
+        encodeTxn(txn, raw.data() + i * sizeof(TxnRecord));
+    }
+    return raw;
+}
+
+/**
+ * decodeBatch — Batch form of processTxn's Steps 1 and 2: convert `count` raw
+ * Big-Endian records to host-order TxnRecords. `raw` and `out` must not
+ * overlap.
+ */
+void decodeBatch(const char* raw, std::size_t count, TxnRecord* out);
+
+/**
+ * TxnColumnsView — Destination of decodeColumns: one array per TxnRecord
+ * field, each with room for the batch (cardType: 4 bytes per record).
+ */
+struct TxnColumnsView {
+    uint32_t* txnId;
+    uint32_t* amountCents;
+    uint16_t* storeNumber;
+    uint16_t* pumpNumber;
+    char*     cardType;
+};
+
+/**
+ * decodeColumns — Decode and transpose in one pass: `count` raw Big-Endian
+ * records into host-order column arrays (the layout Arrow and Parquet
+ * writers consume), with no intermediate TxnRecord array.
+ */
+void decodeColumns(const char* raw, std::size_t count, const TxnColumnsView& out);
+
+/**
+ * convertHfp32Batch / convertHfp64Batch — fromIbmHfp32 / fromIbmHfp64 over
+ * `count` contiguous Big-Endian HFP values at `raw` (see txn_record.h).
+ */
+void convertHfp32Batch(const char* raw, std::size_t count, double* out);
+void convertHfp64Batch(const char* raw, std::size_t count, double* out);
+
+/**
+ * decodeKernelName — The decodeBatch body selected for this host, e.g.
+ * "shuffle/x86-64-v3" or "bswap/default" (exported as a metric label).
+ */
+const char* decodeKernelName();
+
+/**
+ * validateTxn — Reject records that cannot be genuine: a zero transaction ID,
+ * an amount above the $100,000 single-transaction cap, or a card type that
+ * is not printable ASCII (typically an EBCDIC field that was never
+ * converted).
+ */
+inline bool validateTxn(const TxnRecord& txn) {
+    constexpr uint32_t kMaxAmountCents = 10'000'000;
+    if (txn.txnId == 0 || txn.amountCents > kMaxAmountCents)
+        return false;
+    for (char c : txn.cardType)
+        if (c < 0x20 || c > 0x7E)
+            return false;
+    return true;
+}
+
+/**
+ * TxnFilter — Inclusive amount and store-number ranges; the defaults pass
+ * every record.
+ */
+struct TxnFilter {
+    uint32_t minAmountCents = 0;
+    uint32_t maxAmountCents = UINT32_MAX;
+    uint16_t minStore       = 0;
+    uint16_t maxStore       = UINT16_MAX;
+};
+
+/**
+ * filterBatch — Copy the records of `in` that pass `filter` to `out` (in
+ * order) and return how many were kept. `out` may equal `in`.
+ */
+std::size_t filterBatch(const TxnRecord* in, std::size_t count, const TxnFilter& filter,
+                        TxnRecord* out);
+
+struct StoreTotals;
+
+/**
+ * aggregateBatch — validateTxn every record and add the valid ones to
+ * `totals`; returns the number rejected. validate__reject (usdt.h) fires
+ * from a scalar pass after the loop, only when something was rejected.
+ */
+std::size_t aggregateBatch(const TxnRecord* txns, std::size_t count, StoreTotals& totals);
+
+/**
+ * StoreTotals — Sink stage: transaction count and amount per store number.
+ */
+struct StoreTotals {
+    std::vector<uint64_t> txns        = std::vector<uint64_t>(65536, 0);
+    std::vector<uint64_t> amountCents = std::vector<uint64_t>(65536, 0);
+
+    void add(const TxnRecord& txn) {
+        ++txns[txn.storeNumber];
+        amountCents[txn.storeNumber] += txn.amountCents;
+    }
+
+    void merge(const StoreTotals& o) {
+        for (std::size_t s = 0; s < txns.size(); ++s) {
+            txns[s]        += o.txns[s];
+            amountCents[s] += o.amountCents[s];
+        }
+    }
+};
+
+/**
+ * formatTxn — Append the processTxn text layout for one decoded record.
+ * "%g" matches std::ostream's default formatting of the dollar amount.
+ */
+inline void formatTxn(const TxnRecord& txn, std::string& out) {
+    char buf[160];
+    const int n = std::snprintf(buf, sizeof(buf),
+        "Txn ID     : %u\nAmount ($) : %g\nStore      : %u\nPump       : %u\nCard       : %.4s\n",
+        static_cast<unsigned>(txn.txnId), txn.amountCents / 100.0,
+        static_cast<unsigned>(txn.storeNumber), static_cast<unsigned>(txn.pumpNumber),
+        txn.cardType);
+    out.append(buf, static_cast<std::size_t>(n));
+}
+
+/** formatBatch — formatTxn over `count` decoded records. */
+inline void formatBatch(const TxnRecord* txns, std::size_t count, std::string& out) {
+    for (std::size_t i = 0; i < count; ++i)
+        formatTxn(txns[i], out);
+}
@@ -0,0 +1,198 @@
+// txn_record.h — TxnRecord layout and Big-Endian conversion helpers
+//
+// Shared by pos_modern and the benchmarks. See pos_transaction_x86.cpp for
+// the single-record walkthrough that uses them.
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <bit>       // C++20: std::endian for compile-time byte-order detection
+#include <type_traits>
+
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <stdlib.h>  // _byteswap_ushort / _ulong / _uint64
+#endif
+
+// ---------------------------------------------------------------------------
+// Portable byte-swap utilities
+//
+// These functions convert multi-byte integers from Big-Endian (the source
+// data format on OS/400) to the host CPU's native byte order.
+//
+// On a Little-Endian host (x86), the bytes are reversed.
+// On a Big-Endian host, the functions are no-ops (zero overhead).
+//
+// The `if constexpr` check is resolved at COMPILE TIME — there is no
+// runtime branching cost.
+//
+// fromBigEndian<T> covers every integer width, signed types and enums
+// (through their underlying type). It uses C++23 std::byteswap when the
+// library has it, otherwise the compiler intrinsics, otherwise a portable
+// shift loop — and stays constexpr in all three cases. Because a swap is
+// its own inverse, the same function also encodes.
+// ---------------------------------------------------------------------------
+
+/** BigEndianField — Types fromBigEndian accepts: integers and enums. */
+template <typename T>
+concept BigEndianField = std::is_integral_v<T> || std::is_enum_v<T>;
+
+/** byteswapPortable — Manual fallback, portable to any C++ compiler. */
+template <typename U>
+constexpr U byteswapPortable(U u) noexcept {
+    U r = 0;
+    for (std::size_t i = 0; i < sizeof(U); ++i, u >>= 8)
+        r = static_cast<U>(r << 8 | (u & 0xFF));
+    return r;
+}
+
+/**
+ * fromBigEndian — Convert a Big-Endian value of any BigEndianField type to
+ * host byte order.
+ */
+template <BigEndianField T>
+constexpr T fromBigEndian(T v) noexcept {
+    if constexpr (std::is_enum_v<T>) {
+        return static_cast<T>(fromBigEndian(static_cast<std::underlying_type_t<T>>(v)));
+    } else if constexpr (std::endian::native == std::endian::big || sizeof(T) == 1) {
+        return v;  // Already in the correct order
+    } else {
+    #if defined(__cpp_lib_byteswap)
+        return std::byteswap(v);
+    #else
+        using U = std::make_unsigned_t<T>;
+        const U u = static_cast<U>(v);
+        #if defined(__GNUC__) || defined(__clang__)
+            // Single-instruction byte reversal; the builtins are constexpr
+            if constexpr (sizeof(T) == 2) return static_cast<T>(__builtin_bswap16(u));
+            else if constexpr (sizeof(T) == 4) return static_cast<T>(__builtin_bswap32(u));
+            else if constexpr (sizeof(T) == 8) return static_cast<T>(__builtin_bswap64(u));
+            else return static_cast<T>(byteswapPortable(u));
+        #elif defined(_MSC_VER)
+            // The MSVC intrinsics are not constexpr
+            if (std::is_constant_evaluated()) return static_cast<T>(byteswapPortable(u));
+            if constexpr (sizeof(T) == 2) return static_cast<T>(_byteswap_ushort(u));
+            else if constexpr (sizeof(T) == 4) return static_cast<T>(_byteswap_ulong(u));
+            else if constexpr (sizeof(T) == 8) return static_cast<T>(_byteswap_uint64(u));
+            else return static_cast<T>(byteswapPortable(u));
+        #else
+            return static_cast<T>(byteswapPortable(u));
+        #endif
+    #endif
+    }
+}
+
+/** loadBigEndian — Read an unaligned Big-Endian T at `p`, in host order. */
+template <BigEndianField T>
+inline T loadBigEndian(const char* p) noexcept {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return fromBigEndian(v);
+}
+
+/** storeBigEndian — Write `v` at `p` (unaligned) in Big-Endian order. */
+template <BigEndianField T>
+inline void storeBigEndian(char* p, T v) noexcept {
+    v = fromBigEndian(v);
+    std::memcpy(p, &v, sizeof(T));
+}
+
+/**
+ * fromBigEndianBatch — `count` contiguous Big-Endian T values at `raw` into
+ * host order at `out` (which must not overlap `raw`). One memcpy, then a
+ * swap loop with no dependencies between elements, which GCC and Clang
+ * vectorize into byte shuffles at -O3 for whatever ISA the caller targets.
+ */
+template <BigEndianField T>
+inline void fromBigEndianBatch(const char* __restrict raw, std::size_t count, T* __restrict out) noexcept {
+    std::memcpy(out, raw, count * sizeof(T));
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = fromBigEndian(out[i]);
+}
+
+/** fromBigEndianBatch — In place: swap `count` values at `values` to host order. */
+template <BigEndianField T>
+inline void fromBigEndianBatch(T* values, std::size_t count) noexcept {
+    for (std::size_t i = 0; i < count; ++i)
+        values[i] = fromBigEndian(values[i]);
+}
+
+/**
+ * fromBigEndian32 — Convert a 32-bit Big-Endian value to host byte order.
+ * (fromBigEndian<uint32_t>, named for the processTxn walkthrough.)
+ */
+constexpr uint32_t fromBigEndian32(uint32_t v) noexcept { return fromBigEndian(v); }
+
+/**
+ * fromBigEndian16 — Convert a 16-bit Big-Endian value to host byte order.
+ */
+constexpr uint16_t fromBigEndian16(uint16_t v) noexcept { return fromBigEndian(v); }
+
+static_assert(fromBigEndian<uint32_t>(0x11223344) == (std::endian::native == std::endian::little
+                                                      ? 0x44332211u : 0x11223344u),
+              "fromBigEndian must be usable in constant expressions");
+
+// ---------------------------------------------------------------------------
+// IBM hexadecimal floating point (System/360 HFP)
+//
+// Legacy records store rates and volumes as HFP, not IEEE-754:
+//
+//   bit 63/31  sign
+//   7 bits     exponent, excess 64, base 16
+//   56/24 bits fraction 0.F (not necessarily normalized)
+//
+//   value = (-1)^sign × F × 16^(exponent − 64)
+//
+// Both widths convert to an IEEE double without overflow or denormals.
+// HFP32 (24-bit fraction) is always exact; HFP64 (56-bit fraction) is
+// rounded once, to nearest with ties to even. The functions take the bit
+// pattern in host order (after fromBigEndian<uint32_t/uint64_t>); the
+// Big-Endian batch forms are convertHfp32Batch / convertHfp64Batch in
+// txn_batch.h. Everything is branch-free so the batch loops vectorize.
+// ---------------------------------------------------------------------------
+
+/** hfpUint32ToDouble — Exact uint32 → double via the 2^52 magic number. */
+inline double hfpUint32ToDouble(uint64_t v) {
+    return std::bit_cast<double>(0x4330000000000000ULL | v) - 0x1p52;
+}
+
+/** hfpScale — 2^e as a double, for −1022 <= e <= 1023. */
+inline double hfpScale(int e) {
+    return std::bit_cast<double>(static_cast<uint64_t>(e + 1023) << 52);
+}
+
+/** fromIbmHfp32 — Convert a 32-bit HFP bit pattern to double (exact). */
+inline double fromIbmHfp32(uint32_t v) {
+    const double mag = hfpUint32ToDouble(v & 0x00FFFFFF)
+                     * hfpScale(4 * static_cast<int>((v >> 24) & 0x7F) - 256 - 24);
+    return std::bit_cast<double>(std::bit_cast<uint64_t>(mag) | uint64_t{v >> 31} << 63);
+}
+
+/** fromIbmHfp64 — Convert a 64-bit HFP bit pattern to double (rounded to nearest). */
+inline double fromIbmHfp64(uint64_t v) {
+    const uint64_t frac = v & 0x00FFFFFFFFFFFFFFULL;
+    // Both halves are exact; the sum is the only rounding step
+    const double mag = hfpUint32ToDouble(frac >> 32) * 0x1p32 + hfpUint32ToDouble(frac & 0xFFFFFFFF);
+    const double scaled = mag * hfpScale(4 * static_cast<int>((v >> 56) & 0x7F) - 256 - 56);
+    return std::bit_cast<double>(std::bit_cast<uint64_t>(scaled) | (v & 0x8000000000000000ULL));
+}
+
+// ---------------------------------------------------------------------------
+// TxnRecord: UNCHANGED struct layout.
+//
+// The binary format is identical to the OS/400 version. This is critical:
+// it means existing data files, network packets, and legacy exports remain
+// compatible without any reformatting.
+// ---------------------------------------------------------------------------
+struct TxnRecord {
+    uint32_t txnId;          // 4 bytes — Transaction ID
+    uint32_t amountCents;    // 4 bytes — Amount in cents (5000 = $50.00)
+    uint16_t storeNumber;    // 2 bytes — Store identifier
+    uint16_t pumpNumber;     // 2 bytes — Fuel pump number
+    char     cardType[4];    // 4 bytes — Card type ("VISA", "MC", etc.)
+};
+
+// Compile-time guard: ensure no unexpected padding was inserted
+static_assert(sizeof(TxnRecord) == 16,
+    "TxnRecord size mismatch — check struct alignment/padding");
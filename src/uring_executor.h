@@ -0,0 +1,490 @@
+// uring_executor.h — Single-threaded C++20 coroutine executor over io_uring
+//
+// Each TCP connection is a coroutine (UringTask) that suspends on socket
+// I/O submitted to the ring and resumes when its completion arrives. An idle
+// connection costs its coroutine frame — a few hundred bytes — plus one
+// in-flight recv, instead of a thread with its stack.
+//
+//   UringExecutor ex;                       // check ex.ok()
+//   ex.spawn(serve(ex, fd));                // UringTask serve(UringExecutor&, int)
+//   ex.run([] { return stopRequested; });   // until stop, then cancel + drain
+//
+//   inside a task:
+//     int  fd = co_await ex.accept(listenFd);           // -errno on failure
+//     bool ok = co_await ex.recvExactly(fd, buf, len);  // false on EOF/error
+//     bool ok = co_await ex.sendExactly(fd, buf, len);
+//     co_await ex.yield();                              // let other tasks run
+//     co_await ex.sleep(5);                             // resume after 5 ms
+//
+// The ring is driven with the raw io_uring_setup / io_uring_enter syscalls
+// (no liburing). ok() is false unless the kernel implements every opcode
+// used (IORING_REGISTER_PROBE, so Linux 5.6+). Shutdown cancels each
+// in-flight operation by its user_data.
+// The ring itself is UringRing, which UringFileWriter (uring_writer.h) uses
+// for file output.
+// One executor per thread; nothing here is thread-safe.
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <initializer_list>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#if defined(__linux__) && __has_include(<linux/io_uring.h>)
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define POS_HAVE_IO_URING 1
+#endif
+
+#if defined(POS_HAVE_IO_URING)
+
+/**
+ * UringRing — One io_uring instance: the submission and completion rings
+ * mapped into the process and driven with the raw syscalls. UringExecutor
+ * and UringFileWriter (uring_writer.h) each own one. Not thread-safe.
+ */
+class UringRing {
+public:
+    /** `cqEntries` 0 = the kernel's default, twice `entries`. */
+    explicit UringRing(unsigned entries, unsigned cqEntries = 0) {
+        io_uring_params p{};
+        if (cqEntries != 0) {
+            p.flags      = IORING_SETUP_CQSIZE;
+            p.cq_entries = cqEntries;
+        }
+        fd_ = static_cast<int>(::syscall(__NR_io_uring_setup, entries, &p));
+        if (fd_ < 0) {
+            error_ = errno;
+            return;
+        }
+
+        sqRingSize_ = p.sq_off.array + p.sq_entries * sizeof(unsigned);
+        cqRingSize_ = p.cq_off.cqes + p.cq_entries * sizeof(io_uring_cqe);
+        const bool single = p.features & IORING_FEAT_SINGLE_MMAP;
+        if (single) sqRingSize_ = cqRingSize_ = std::max(sqRingSize_, cqRingSize_);
+
+        sqRing_ = ::mmap(nullptr, sqRingSize_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQ_RING);
+        cqRing_ = single ? sqRing_
+                         : ::mmap(nullptr, cqRingSize_, PROT_READ | PROT_WRITE,
+                                  MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_CQ_RING);
+        sqes_ = static_cast<io_uring_sqe*>(
+            ::mmap(nullptr, p.sq_entries * sizeof(io_uring_sqe), PROT_READ | PROT_WRITE,
+                   MAP_SHARED | MAP_POPULATE, fd_, IORING_OFF_SQES));
+        if (sqRing_ == MAP_FAILED || cqRing_ == MAP_FAILED || sqes_ == MAP_FAILED) {
+            error_ = errno;
+            return;
+        }
+        sqEntries_ = p.sq_entries;
+
+        auto* sq = static_cast<char*>(sqRing_);
+        sqHead_ = reinterpret_cast<unsigned*>(sq + p.sq_off.head);
+        sqTail_ = reinterpret_cast<unsigned*>(sq + p.sq_off.tail);
+        sqMask_ = *reinterpret_cast<unsigned*>(sq + p.sq_off.ring_mask);
+        auto* array = reinterpret_cast<unsigned*>(sq + p.sq_off.array);
+        for (unsigned i = 0; i < p.sq_entries; ++i) array[i] = i;   // identity SQE map
+
+        auto* cq = static_cast<char*>(cqRing_);
+        cqHead_ = reinterpret_cast<unsigned*>(cq + p.cq_off.head);
+        cqTail_ = reinterpret_cast<unsigned*>(cq + p.cq_off.tail);
+        cqMask_ = *reinterpret_cast<unsigned*>(cq + p.cq_off.ring_mask);
+        cqes_   = reinterpret_cast<io_uring_cqe*>(cq + p.cq_off.cqes);
+        ok_ = true;
+    }
+
+    ~UringRing() {
+        if (sqes_ && sqes_ != MAP_FAILED) ::munmap(sqes_, sqEntries_ * sizeof(io_uring_sqe));
+        if (cqRing_ && cqRing_ != MAP_FAILED && cqRing_ != sqRing_) ::munmap(cqRing_, cqRingSize_);
+        if (sqRing_ && sqRing_ != MAP_FAILED) ::munmap(sqRing_, sqRingSize_);
+        if (fd_ >= 0) ::close(fd_);
+    }
+
+    UringRing(const UringRing&) = delete;
+    UringRing& operator=(const UringRing&) = delete;
+
+    bool ok() const { return ok_; }
+    int  error() const { return error_; }
+
+    /**
+     * supports — Whether the kernel implements every opcode in `ops`. Asks
+     * with IORING_REGISTER_PROBE, so false on kernels older than 5.6.
+     */
+    bool supports(std::initializer_list<uint8_t> ops) const {
+        constexpr unsigned kOps = 256;
+        std::vector<io_uring_probe_op> mem(kOps + sizeof(io_uring_probe) / sizeof(io_uring_probe_op));
+        auto* probe = reinterpret_cast<io_uring_probe*>(mem.data());
+        if (!ok_ || ::syscall(__NR_io_uring_register, fd_, IORING_REGISTER_PROBE, probe, kOps) < 0)
+            return false;
+        for (uint8_t op : ops)
+            if (op > probe->last_op || !(probe->ops[op].flags & IO_URING_OP_SUPPORTED)) return false;
+        return true;
+    }
+
+    /** nextSqe — A zeroed SQE, submitting the queued ones first if the ring is full. */
+    io_uring_sqe* nextSqe() {
+        if (sqeTail_ - std::atomic_ref<unsigned>(*sqHead_).load(std::memory_order_acquire)
+            == sqEntries_)
+            enter(0);
+        io_uring_sqe* sqe = &sqes_[sqeTail_ & sqMask_];
+        std::memset(sqe, 0, sizeof(*sqe));
+        ++sqeTail_;
+        return sqe;
+    }
+
+    /** enter — Submit pending SQEs and wait for at least `minComplete` CQEs. */
+    void enter(unsigned minComplete) {
+        std::atomic_ref<unsigned>(*sqTail_).store(sqeTail_, std::memory_order_release);
+        const unsigned pending =
+            sqeTail_ - std::atomic_ref<unsigned>(*sqHead_).load(std::memory_order_acquire);
+        if (pending == 0 && minComplete == 0) return;
+        ::syscall(__NR_io_uring_enter, fd_, pending, minComplete,
+                  minComplete ? IORING_ENTER_GETEVENTS : 0u, nullptr, 0);
+    }
+
+    /** reap — onCqe(cqe) for every available CQE; it may queue new SQEs. */
+    template <typename OnCqe>
+    void reap(OnCqe&& onCqe) {
+        std::atomic_ref<unsigned> tailRef(*cqTail_), headRef(*cqHead_);
+        unsigned head = headRef.load(std::memory_order_relaxed);
+        const unsigned tail = tailRef.load(std::memory_order_acquire);
+        for (; head != tail; ++head) onCqe(cqes_[head & cqMask_]);
+        headRef.store(head, std::memory_order_release);
+    }
+
+private:
+    int   fd_ = -1;
+    int   error_ = 0;
+    bool  ok_ = false;
+    void* sqRing_ = nullptr;
+    void* cqRing_ = nullptr;
+    std::size_t sqRingSize_ = 0, cqRingSize_ = 0;
+    io_uring_sqe* sqes_ = nullptr;
+    io_uring_cqe* cqes_ = nullptr;
+    unsigned  sqEntries_ = 0, sqMask_ = 0, cqMask_ = 0;
+    unsigned* sqHead_ = nullptr;
+    unsigned* sqTail_ = nullptr;
+    unsigned* cqHead_ = nullptr;
+    unsigned* cqTail_ = nullptr;
+    unsigned  sqeTail_ = 0;
+};
+
+class UringExecutor;
+
+/**
+ * UringTask — Detached coroutine owned by an executor. It starts when
+ * spawned and its frame is freed when it returns (or when the executor
+ * shuts down while it is still suspended).
+ */
+class UringTask {
+public:
+    struct promise_type {
+        UringExecutor* executor = nullptr;
+
+        UringTask get_return_object() {
+            return UringTask{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        auto final_suspend() noexcept;
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { std::terminate(); }
+    };
+
+    UringTask(UringTask&& o) noexcept : handle_(std::exchange(o.handle_, {})) {}
+    ~UringTask() { if (handle_) handle_.destroy(); }
+
+private:
+    friend class UringExecutor;
+    explicit UringTask(std::coroutine_handle<promise_type> h) : handle_(h) {}
+    std::coroutine_handle<promise_type> handle_;
+};
+
+/**
+ * UringExecutor — The ring, the ready queue, and every live task.
+ */
+class UringExecutor {
+public:
+    /** Completion — In-flight operation; its address is the SQE user_data. */
+    struct Completion {
+        std::coroutine_handle<> handle;
+        int                     result = 0;
+        // Exact-length transfers resubmit themselves until done
+        int                     fd = -1;
+        uint8_t                 opcode = 0;
+        char*                   buf = nullptr;
+        std::size_t             remaining = 0;
+        // Intrusive list of in-flight operations, for cancellation at shutdown
+        Completion*             prev = nullptr;
+        Completion*             next = nullptr;
+    };
+
+    explicit UringExecutor(unsigned entries = 4096, unsigned cqEntries = 65536)
+        : ring_(entries, cqEntries),
+          supported_(ring_.supports({IORING_OP_ACCEPT, IORING_OP_RECV, IORING_OP_SEND, IORING_OP_TIMEOUT,
+                                     IORING_OP_TIMEOUT_REMOVE, IORING_OP_ASYNC_CANCEL})) {}
+
+    ~UringExecutor() {
+        for (void* frame : live_)
+            std::coroutine_handle<>::from_address(frame).destroy();
+    }
+
+    UringExecutor(const UringExecutor&) = delete;
+    UringExecutor& operator=(const UringExecutor&) = delete;
+
+    bool ok() const { return supported_; }
+    int  error() const { return ring_.ok() ? EOPNOTSUPP : ring_.error(); }
+
+    /** liveTasks / peakTasks — Current and highest number of spawned tasks. */
+    std::size_t liveTasks() const { return live_.size(); }
+    std::size_t peakTasks() const { return peak_; }
+
+    /** spawn — Take ownership of `task` and schedule its first step. */
+    void spawn(UringTask task) {
+        auto h = std::exchange(task.handle_, {});
+        h.promise().executor = this;
+        live_.insert(h.address());
+        peak_ = std::max(peak_, live_.size());
+        ready_.push_back(h);
+    }
+
+    /** Awaitable for one submitted operation; resumes with the CQE result. */
+    struct Op {
+        UringExecutor& ex;
+        Completion     c;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> h) {
+            c.handle = h;
+            ex.submit(c);
+        }
+        int await_resume() const noexcept { return c.result; }
+    };
+
+    /** ExactOp — recv/send of exactly `len` bytes; resumes with success. */
+    struct ExactOp : Op {
+        bool await_resume() const noexcept { return this->c.result > 0 && this->c.remaining == 0; }
+    };
+
+    Op accept(int listenFd) {
+        return Op{*this, Completion{{}, 0, listenFd, IORING_OP_ACCEPT, nullptr, 0}};
+    }
+    ExactOp recvExactly(int fd, void* buf, std::size_t len) {
+        return ExactOp{{*this, Completion{{}, 0, fd, IORING_OP_RECV, static_cast<char*>(buf), len}}};
+    }
+    ExactOp sendExactly(int fd, const void* buf, std::size_t len) {
+        return ExactOp{{*this, Completion{{}, 0, fd, IORING_OP_SEND,
+                                          static_cast<char*>(const_cast<void*>(buf)), len}}};
+    }
+
+    /** SleepOp — IORING_OP_TIMEOUT; `ts` lives in the awaiting frame while it is in flight. */
+    struct SleepOp : Op {
+        __kernel_timespec ts;
+        void await_suspend(std::coroutine_handle<> h) {
+            this->c.buf = reinterpret_cast<char*>(&ts);
+            Op::await_suspend(h);
+        }
+    };
+
+    /** sleep — Resume the calling task after `ms` milliseconds. */
+    SleepOp sleep(int ms) {
+        return SleepOp{{*this, Completion{{}, 0, -1, IORING_OP_TIMEOUT, nullptr, 0}},
+                       {ms / 1000, static_cast<long long>(ms % 1000) * 1000000}};
+    }
+
+    /** yield — Requeue the calling task behind everything already ready. */
+    auto yield() {
+        struct Awaiter {
+            UringExecutor& ex;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> h) { ex.ready_.push_back(h); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+
+    /**
+     * run — Resume ready tasks and reap completions until `stop()` returns
+     * true (checked at least every `tickMs`, and after every `onTick`), then
+     * cancel whatever is still in flight and wait for it to drain so no
+     * operation outlives the buffers in the task frames. Tasks still ready
+     * at the stop are not resumed again; their frames go with the executor.
+     */
+    void run(const std::function<bool()>& stop, const std::function<void()>& onTick = {},
+             int tickMs = 200) {
+        tick_.tv_sec  = tickMs / 1000;
+        tick_.tv_nsec = static_cast<long long>(tickMs % 1000) * 1000000;
+        armTick();
+        while (!stop()) {
+            runReady();
+            enter(1);
+            reap();
+            if (tickFired_) {
+                tickFired_ = false;
+                if (onTick) onTick();
+                armTick();
+            }
+        }
+
+        // Nothing runs from here on, and a non-empty ready_ would turn enter(1)
+        // into a busy poll
+        stopping_ = true;
+        ready_.clear();
+        while (inflight_ > 0 || tickArmed_) {
+            // Another round once the last one has answered, for any operation it missed
+            if (cancels_ == 0) cancelAll();
+            enter(1);
+            reap();
+        }
+    }
+
+private:
+    static constexpr uint64_t kTickTag   = 1;
+    static constexpr uint64_t kCancelTag = 2;
+
+    friend auto UringTask::promise_type::final_suspend() noexcept;
+
+    void retire(std::coroutine_handle<> h) {
+        live_.erase(h.address());
+        h.destroy();
+    }
+
+    void submit(Completion& c) {
+        c.prev = nullptr;
+        c.next = inflightHead_;
+        if (inflightHead_) inflightHead_->prev = &c;
+        inflightHead_ = &c;
+        io_uring_sqe* sqe = ring_.nextSqe();
+        sqe->opcode    = c.opcode;
+        sqe->fd        = c.fd;
+        sqe->user_data = reinterpret_cast<uint64_t>(&c);
+        if (c.opcode == IORING_OP_ACCEPT) {
+            sqe->accept_flags = SOCK_CLOEXEC;
+        } else if (c.opcode == IORING_OP_TIMEOUT) {
+            sqe->addr = reinterpret_cast<uint64_t>(c.buf);
+            sqe->len  = 1;
+        } else {
+            sqe->addr      = reinterpret_cast<uint64_t>(c.buf);
+            sqe->len       = static_cast<uint32_t>(c.remaining);
+            sqe->msg_flags = c.opcode == IORING_OP_SEND ? MSG_NOSIGNAL : 0;
+        }
+        ++inflight_;
+    }
+
+    void armTick() {
+        io_uring_sqe* sqe = ring_.nextSqe();
+        sqe->opcode    = IORING_OP_TIMEOUT;
+        sqe->fd        = -1;
+        sqe->addr      = reinterpret_cast<uint64_t>(&tick_);
+        sqe->len       = 1;
+        sqe->user_data = kTickTag;
+        tickArmed_ = true;
+    }
+
+    void unlink(Completion& c) {
+        (c.prev ? c.prev->next : inflightHead_) = c.next;
+        if (c.next) c.next->prev = c.prev;
+    }
+
+    /** cancelAll — Cancel the tick and every in-flight operation, each by its user_data. */
+    void cancelAll() {
+        if (tickArmed_) {
+            io_uring_sqe* sqe = ring_.nextSqe();
+            sqe->opcode    = IORING_OP_TIMEOUT_REMOVE;
+            sqe->fd        = -1;
+            sqe->addr      = kTickTag;
+            sqe->user_data = kCancelTag;
+            ++cancels_;
+        }
+        for (Completion* c = inflightHead_; c; c = c->next) {
+            io_uring_sqe* sqe = ring_.nextSqe();
+            sqe->opcode    = c->opcode == IORING_OP_TIMEOUT ? IORING_OP_TIMEOUT_REMOVE
+                                                            : IORING_OP_ASYNC_CANCEL;
+            sqe->fd        = -1;
+            sqe->addr      = reinterpret_cast<uint64_t>(c);
+            sqe->user_data = kCancelTag;
+            ++cancels_;
+        }
+    }
+
+    /** enter — Submit, and wait for `minComplete` CQEs unless a task is ready. */
+    void enter(unsigned minComplete) { ring_.enter(ready_.empty() ? minComplete : 0); }
+
+    /** reap — Consume every available CQE, queueing finished tasks. */
+    void reap() {
+        ring_.reap([this](const io_uring_cqe& cqe) {
+            if (cqe.user_data == kTickTag) {
+                tickArmed_ = false;
+                tickFired_ = true;
+                return;
+            }
+            if (cqe.user_data == kCancelTag) {
+                --cancels_;
+                return;
+            }
+
+            auto& c = *reinterpret_cast<Completion*>(cqe.user_data);
+            unlink(c);
+            --inflight_;
+            c.result = cqe.res;
+            if (c.opcode != IORING_OP_ACCEPT && c.opcode != IORING_OP_TIMEOUT && cqe.res > 0) {
+                c.buf       += cqe.res;
+                c.remaining -= static_cast<std::size_t>(cqe.res);
+                if (c.remaining > 0 && !stopping_) {
+                    submit(c);   // short transfer: continue without waking the task
+                    return;
+                }
+            }
+            if (!stopping_) ready_.push_back(c.handle);
+        });
+    }
+
+    void runReady() {
+        // Only the tasks ready now; anything they requeue waits for the next round
+        for (std::size_t n = ready_.size(); n > 0 && !ready_.empty(); --n) {
+            auto h = ready_.front();
+            ready_.pop_front();
+            h.resume();
+        }
+    }
+
+    UringRing ring_;
+    bool      supported_;
+
+    std::deque<std::coroutine_handle<>> ready_;
+    std::unordered_set<void*>           live_;
+    std::size_t                         peak_ = 0;
+    std::size_t                         inflight_ = 0;
+    Completion*                         inflightHead_ = nullptr;
+    std::size_t                         cancels_ = 0;      // cancel requests not yet answered
+    __kernel_timespec                   tick_{};
+    bool                                tickArmed_ = false;
+    bool                                tickFired_ = false;
+    bool                                stopping_  = false;
+};
+
+inline auto UringTask::promise_type::final_suspend() noexcept {
+    struct Retire {
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<promise_type> h) noexcept {
+            h.promise().executor->retire(h);
+        }
+        void await_resume() const noexcept {}
+    };
+    return Retire{};
+}
+
+#endif  // POS_HAVE_IO_URING
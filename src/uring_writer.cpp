@@ -0,0 +1,444 @@
+// uring_writer.cpp — UringFileWriter: the io_uring and pwrite writer threads
+
+#include "uring_writer.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "uring_executor.h"
+
+#if defined(POS_HAVE_IO_URING)
+#include <sys/eventfd.h>
+#endif
+
+namespace {
+
+// user_data of the writer's own operations; buffers are never at these addresses
+constexpr uint64_t kWakeTag   = 1;
+constexpr uint64_t kTickTag   = 2;
+constexpr uint64_t kSyncTag   = 3;
+constexpr uint64_t kCancelTag = 4;
+
+std::size_t roundUp(std::size_t n, std::size_t align) { return (n + align - 1) / align * align; }
+
+/** PendingWrites — Completion of writes in submission order, for the durable prefix. */
+class PendingWrites {
+public:
+    uint64_t push(uint64_t end) {
+        ends_.push_back(Entry{end, false});
+        return first_ + ends_.size() - 1;
+    }
+    /** complete — Mark write `seq` done; returns the end of the completed prefix. */
+    uint64_t complete(uint64_t seq) {
+        ends_[seq - first_].done = true;
+        while (!ends_.empty() && ends_.front().done) {
+            prefix_ = ends_.front().end;
+            ends_.pop_front();
+            ++first_;
+        }
+        return prefix_;
+    }
+    uint64_t prefix() const { return prefix_; }
+
+private:
+    struct Entry {
+        uint64_t end;
+        bool     done;
+    };
+    std::deque<Entry> ends_;
+    uint64_t          first_  = 0;
+    uint64_t          prefix_ = 0;
+};
+
+}  // namespace
+
+UringFileWriter::UringFileWriter(const std::string& path, const Options& options) : options_(options) {
+    options_.bufferBytes = roundUp(std::max<std::size_t>(options_.bufferBytes, 1), kAlign);
+    options_.buffers     = std::max<std::size_t>(options_.buffers, 1);
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC | (options_.direct ? O_DIRECT : 0), 0644);
+    if (fd_ < 0) {
+        error_ = "cannot write " + path + ": " + std::strerror(errno);
+        return;
+    }
+    memory_ = PageBuffer(options_.bufferBytes * options_.buffers);
+    if (!memory_.data()) {
+        error_ = "cannot allocate output buffers";
+        return;
+    }
+    pool_.resize(options_.buffers);
+    for (std::size_t i = 0; i < pool_.size(); ++i) {
+        pool_[i].data     = memory_.data() + i * options_.bufferBytes;
+        pool_[i].capacity = options_.bufferBytes;
+        free_.push_back(&pool_[i]);
+    }
+#if defined(POS_HAVE_IO_URING)
+    wakeFd_ = ::eventfd(0, EFD_CLOEXEC);
+#endif
+    thread_ = std::thread([this] { run(); });
+    std::unique_lock lock(mutex_);
+    freed_.wait(lock, [&] { return started_; });
+}
+
+UringFileWriter::~UringFileWriter() { close(); }
+
+bool UringFileWriter::ok() const {
+    std::lock_guard lock(mutex_);
+    return error_.empty();
+}
+
+std::string UringFileWriter::error() const {
+    std::lock_guard lock(mutex_);
+    return error_;
+}
+
+const char* UringFileWriter::engine() const { return useRing_ ? "io_uring" : "pwrite"; }
+
+void UringFileWriter::fail(const std::string& what) {
+    std::lock_guard lock(mutex_);
+    if (error_.empty()) error_ = what;
+}
+
+void UringFileWriter::recycle(Buffer* b) {
+    {
+        std::lock_guard lock(mutex_);
+        b->size = 0;
+        free_.push_back(b);
+    }
+    freed_.notify_one();
+}
+
+UringFileWriter::Buffer* UringFileWriter::acquire() {
+    std::unique_lock lock(mutex_);
+    if (free_.empty()) {
+        stalls_.fetch_add(1, std::memory_order_relaxed);
+        freed_.wait(lock, [&] { return !free_.empty(); });
+    }
+    Buffer* b = free_.back();
+    free_.pop_back();
+    b->size = 0;
+    return b;
+}
+
+void UringFileWriter::release(Buffer* b) { recycle(b); }
+
+void UringFileWriter::submit(Buffer* b) {
+    {
+        std::lock_guard lock(mutex_);
+        if (options_.direct && nextOffset_ != logicalEnd_ && error_.empty())
+            error_ = "O_DIRECT output: only the last buffer may be partial";
+        if (b->size == 0 || !error_.empty() || closing_) {
+            b->size = 0;
+            free_.push_back(b);
+            freed_.notify_one();
+            return;
+        }
+        b->length = options_.direct ? roundUp(b->size, kAlign) : b->size;
+        std::memset(b->data + b->size, 0, b->length - b->size);
+        b->offset = nextOffset_;
+        b->done   = 0;
+        nextOffset_ += b->length;
+        logicalEnd_ = b->offset + b->size;
+        queued_.push_back(b);
+    }
+    queuedCv_.notify_one();
+    if (wakeFd_ >= 0) {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    }
+}
+
+bool UringFileWriter::close() {
+    {
+        std::lock_guard lock(mutex_);
+        if (closed_) return error_.empty();
+        closed_  = true;
+        closing_ = true;
+    }
+    queuedCv_.notify_one();
+    if (wakeFd_ >= 0) {
+        const uint64_t one = 1;
+        [[maybe_unused]] const ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+    }
+    if (thread_.joinable()) thread_.join();
+    if (fd_ >= 0 && ::close(fd_) != 0) fail(std::string("close: ") + std::strerror(errno));
+    if (wakeFd_ >= 0) ::close(wakeFd_);
+    fd_ = wakeFd_ = -1;
+    return ok();
+}
+
+void UringFileWriter::run() {
+#if defined(POS_HAVE_IO_URING)
+    UringRing ring(64);
+    {
+        std::lock_guard lock(mutex_);
+        useRing_ = ring.ok() && wakeFd_ >= 0
+                && ring.supports({IORING_OP_READ, IORING_OP_WRITE, IORING_OP_FSYNC, IORING_OP_TIMEOUT,
+                                  IORING_OP_TIMEOUT_REMOVE, IORING_OP_ASYNC_CANCEL});
+        started_ = true;
+    }
+    freed_.notify_all();
+    if (useRing_) {
+        runRing(ring);
+        return;
+    }
+#else
+    {
+        std::lock_guard lock(mutex_);
+        started_ = true;
+    }
+    freed_.notify_all();
+#endif
+    runPwrite();
+}
+
+#if defined(POS_HAVE_IO_URING)
+
+void UringFileWriter::runRing(UringRing& ring) {
+    uint64_t wakeValue = 0;
+    __kernel_timespec tick{};
+    tick.tv_sec  = static_cast<long long>(options_.durabilityMs / 1000);
+    tick.tv_nsec = static_cast<long long>(options_.durabilityMs % 1000) * 1000000;
+
+    auto armWake = [&] {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode    = IORING_OP_READ;
+        sqe->fd        = wakeFd_;
+        sqe->addr      = reinterpret_cast<uint64_t>(&wakeValue);
+        sqe->len       = sizeof(wakeValue);
+        sqe->user_data = kWakeTag;
+    };
+    auto armTick = [&] {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode    = IORING_OP_TIMEOUT;
+        sqe->fd        = -1;
+        sqe->addr      = reinterpret_cast<uint64_t>(&tick);
+        sqe->len       = 1;
+        sqe->user_data = kTickTag;
+    };
+    // Stop: cancel the wake read and the tick, each by its user_data
+    auto cancelTimers = [&](bool wakeArmed, bool tickArmed) {
+        if (wakeArmed) {
+            io_uring_sqe* sqe = ring.nextSqe();
+            sqe->opcode    = IORING_OP_ASYNC_CANCEL;
+            sqe->fd        = -1;
+            sqe->addr      = kWakeTag;
+            sqe->user_data = kCancelTag;
+            // A read already blocked in a kernel worker may miss the cancel; this completes it
+            const uint64_t one = 1;
+            [[maybe_unused]] const ssize_t n = ::write(wakeFd_, &one, sizeof(one));
+        }
+        if (tickArmed) {
+            io_uring_sqe* sqe = ring.nextSqe();
+            sqe->opcode    = IORING_OP_TIMEOUT_REMOVE;
+            sqe->fd        = -1;
+            sqe->addr      = kTickTag;
+            sqe->user_data = kCancelTag;
+        }
+    };
+    auto submitWrite = [&](Buffer* b) {
+        io_uring_sqe* sqe = ring.nextSqe();
+        sqe->opcode    = IORING_OP_WRITE;
+        sqe->fd        = fd_;
+        sqe->addr      = reinterpret_cast<uint64_t>(b->data + b->done);
+        sqe->len       = static_cast<uint32_t>(b->length - b->done);
+        sqe->off       = b->offset + b->done;
+        sqe->user_data = reinterpret_cast<uint64_t>(b);
+        writes_.fetch_add(1, std::memory_order_relaxed);
+    };
+
+    PendingWrites pending;
+    std::size_t inflight = 0;
+    bool wakeArmed = true, tickArmed = options_.durabilityMs != 0;
+    bool syncDue = false, syncInFlight = false, draining = false, stopping = false, trimmed = false;
+    uint64_t syncPrefix = 0, syncDurable = 0, synced = 0;   // synced: file prefix, padding included
+    armWake();
+    if (tickArmed) armTick();
+
+    while (!stopping || wakeArmed || tickArmed || syncInFlight) {
+        if (!stopping) {
+            std::deque<Buffer*> work;
+            {
+                std::lock_guard lock(mutex_);
+                work.swap(queued_);
+                draining = closing_;
+            }
+            for (Buffer* b : work) {
+                b->seq = pending.push(b->offset + b->length);
+                submitWrite(b);
+                ++inflight;
+            }
+            const bool last = draining && inflight == 0;
+            uint64_t logicalEnd = 0;
+            if (!syncInFlight && (syncDue || last)) {
+                std::lock_guard lock(mutex_);
+                logicalEnd = logicalEnd_;
+            }
+            // Under O_DIRECT the last buffer is padded: cut the padding off
+            // before the final sync, even if a tick already synced the data,
+            // since the new size needs syncing too
+            const bool trim = last && options_.direct && !trimmed && logicalEnd != pending.prefix();
+            if (!syncInFlight && (syncDue || last) && (pending.prefix() > synced || trim) && ok()) {
+                if (trim) {
+                    if (::ftruncate(fd_, static_cast<off_t>(logicalEnd)) != 0)
+                        fail(std::string("ftruncate: ") + std::strerror(errno));
+                    trimmed = true;
+                }
+                io_uring_sqe* sqe = ring.nextSqe();
+                sqe->opcode      = IORING_OP_FSYNC;
+                sqe->fd          = fd_;
+                sqe->fsync_flags = IORING_FSYNC_DATASYNC;
+                sqe->user_data   = kSyncTag;
+                syncPrefix   = pending.prefix();
+                syncDurable  = std::min(syncPrefix, logicalEnd);
+                syncInFlight = true;
+                syncDue      = false;
+            }
+            if (!syncInFlight) syncDue = false;   // nothing new to sync; a tick during a sync waits for it
+            if (last && !syncInFlight && pending.prefix() <= synced) {
+                // Everything written and synced
+                cancelTimers(wakeArmed, tickArmed);
+                stopping = true;
+            }
+        }
+        ring.enter(1);
+        ring.reap([&](const io_uring_cqe& cqe) {
+            switch (cqe.user_data) {
+            case kWakeTag:
+                wakeArmed = false;
+                if (stopping) return;
+                if (cqe.res < 0) {
+                    // Never re-armed on an error: it would fail again at once
+                    fail(std::string("eventfd read: ") + std::strerror(-cqe.res));
+                    return;
+                }
+                armWake();
+                wakeArmed = true;
+                return;
+            case kTickTag:
+                tickArmed = false;
+                syncDue   = true;
+                if (stopping) return;
+                if (cqe.res != -ETIME) {   // a timeout that expired completes with -ETIME
+                    fail(std::string("timeout: ") + std::strerror(-cqe.res));
+                    return;
+                }
+                armTick();
+                tickArmed = true;
+                return;
+            case kSyncTag:
+                syncInFlight = false;
+                if (cqe.res < 0) {
+                    fail(std::string("fdatasync: ") + std::strerror(-cqe.res));
+                } else {
+                    synced = syncPrefix;
+                    durable_.store(syncDurable, std::memory_order_relaxed);
+                    syncs_.fetch_add(1, std::memory_order_relaxed);
+                }
+                return;
+            case kCancelTag:
+                return;
+            default:
+                break;
+            }
+            auto* b = reinterpret_cast<Buffer*>(cqe.user_data);
+            if (cqe.res > 0 && b->done + static_cast<std::size_t>(cqe.res) < b->length) {
+                b->done += static_cast<std::size_t>(cqe.res);
+                submitWrite(b);   // short write: continue where it stopped
+                return;
+            }
+            if (cqe.res <= 0)
+                fail(std::string("write: ") + (cqe.res < 0 ? std::strerror(-cqe.res) : "no progress"));
+            else
+                written_.fetch_add(b->size, std::memory_order_relaxed);
+            pending.complete(b->seq);
+            --inflight;
+            recycle(b);
+        });
+        if (!ok() && inflight == 0 && !syncInFlight) {
+            // After an error: hand back whatever is still queued, then stop.
+            // submit() drops everything from here on, so nothing needs a wake.
+            std::lock_guard lock(mutex_);
+            for (Buffer* b : queued_) free_.push_back(b);
+            queued_.clear();
+            freed_.notify_all();
+            if (!stopping) {
+                cancelTimers(wakeArmed, tickArmed);
+                stopping = true;
+            }
+        }
+    }
+}
+
+#else
+
+void UringFileWriter::runRing(UringRing&) {}
+
+#endif
+
+void UringFileWriter::runPwrite() {
+    using Clock = std::chrono::steady_clock;
+    const auto interval = std::chrono::milliseconds(options_.durabilityMs);
+    auto lastSync = Clock::now();
+    uint64_t end = 0, synced = 0;
+    for (;;) {
+        Buffer* b = nullptr;
+        bool closing;
+        uint64_t logicalEnd;
+        {
+            std::unique_lock lock(mutex_);
+            auto ready = [&] { return !queued_.empty() || closing_; };
+            if (options_.durabilityMs != 0)
+                queuedCv_.wait_for(lock, interval, ready);
+            else
+                queuedCv_.wait(lock, ready);
+            if (!queued_.empty()) {
+                b = queued_.front();
+                queued_.pop_front();
+            }
+            closing    = closing_;
+            logicalEnd = logicalEnd_;
+        }
+        if (b) {
+            bool written = ok();
+            while (written && b->done < b->length) {
+                const ssize_t n = ::pwrite(fd_, b->data + b->done, b->length - b->done,
+                                           static_cast<off_t>(b->offset + b->done));
+                writes_.fetch_add(1, std::memory_order_relaxed);
+                if (n > 0) {
+                    b->done += static_cast<std::size_t>(n);
+                } else if (n == 0 || errno != EINTR) {
+                    fail(std::string("write: ") + (n == 0 ? "no progress" : std::strerror(errno)));
+                    written = false;
+                }
+            }
+            if (written) {
+                written_.fetch_add(b->size, std::memory_order_relaxed);
+                end = b->offset + b->length;
+            }
+            recycle(b);
+        }
+        const bool last = closing && !b;
+        const bool due = options_.durabilityMs != 0 && Clock::now() - lastSync >= interval;
+        // The padding is cut off (and the new size synced) even when a
+        // timed sync has already covered the data, as in runRing
+        const bool trim = last && options_.direct && logicalEnd != end;
+        if ((due || last) && (end > synced || trim) && ok()) {
+            if (trim && ::ftruncate(fd_, static_cast<off_t>(logicalEnd)) != 0)
+                fail(std::string("ftruncate: ") + std::strerror(errno));
+            if (::fdatasync(fd_) != 0) {
+                fail(std::string("fdatasync: ") + std::strerror(errno));
+            } else {
+                synced = end;
+                durable_.store(std::min(end, logicalEnd), std::memory_order_relaxed);
+                syncs_.fetch_add(1, std::memory_order_relaxed);
+            }
+            lastSync = Clock::now();
+        }
+        if (last) return;
+    }
+}
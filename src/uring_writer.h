@@ -0,0 +1,131 @@
+// uring_writer.h — Asynchronous file output through io_uring, with group commit
+//
+// The output runners used to write from the thread that decodes and
+// formats, so every write() stalled that thread on the page cache (or the
+// disk, under O_DIRECT). UringFileWriter takes the write off those threads:
+//
+//   Buffer* b = out.acquire();       // page-aligned, from the free-list
+//   ... fill b->data, set b->size ...
+//   out.submit(b);                   // queued; written at the next offset
+//   out.close();                     // drain, final fdatasync
+//
+// One writer thread owns an io_uring (UringRing, uring_executor.h). It
+// turns each submitted buffer into one IORING_OP_WRITE at the buffer's file
+// offset, so several large writes are in flight at once, and hands the
+// buffer back to the free-list when its write completes. Producers only
+// ever wait in acquire(), and only when every buffer is queued or in
+// flight: that is the back-pressure of a disk that cannot keep up, not a
+// wait on each write.
+//
+// Durability is a group commit. Every `durabilityMs` the writer issues
+// one fdatasync covering every write completed so far, however many
+// batches that is. durableBytes() is the prefix of the file that is on
+// stable storage. With durabilityMs 0 the only sync is at close().
+//
+// Buffers are aligned to, and sized in multiples of, kAlign. With `direct`
+// the file is opened O_DIRECT. Every buffer but the last must then be
+// full, because the last one is padded to kAlign and the file is
+// truncated back to its true length at close().
+//
+// Hosts without io_uring, or whose kernel lacks an opcode the writer uses
+// (IORING_OP_READ / WRITE are 5.6+; checked with UringRing::supports), get
+// the same interface backed by a plain writer thread (pwrite + fdatasync).
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "numa_topology.h"
+
+class UringRing;
+
+/** UringFileWriter — Sequential file written from a pool of buffers on a writer thread. */
+class UringFileWriter {
+public:
+    static constexpr std::size_t kAlign = 4096;
+
+    struct Options {
+        std::size_t bufferBytes  = std::size_t{1} << 20;   // rounded up to kAlign
+        std::size_t buffers      = 8;
+        std::size_t durabilityMs = 0;                      // group-commit interval; 0 = at close only
+        bool        direct       = false;                  // O_DIRECT
+    };
+
+    /** Buffer — One pooled, kAlign-aligned block; fill data[0, size). */
+    struct Buffer {
+        char*       data     = nullptr;
+        std::size_t capacity = 0;
+        std::size_t size     = 0;
+        // Writer-thread state while queued or in flight
+        uint64_t    offset   = 0;
+        std::size_t length   = 0;     // size, padded to kAlign under O_DIRECT
+        std::size_t done     = 0;
+        uint64_t    seq      = 0;
+    };
+
+    /** Truncates or creates `path` and starts the writer thread; check ok(). */
+    UringFileWriter(const std::string& path, const Options& options);
+    ~UringFileWriter();
+
+    UringFileWriter(const UringFileWriter&) = delete;
+    UringFileWriter& operator=(const UringFileWriter&) = delete;
+
+    /** acquire — A free buffer (size 0), waiting while none is. Thread-safe. */
+    Buffer* acquire();
+
+    /** submit — Queue `b` to be written after every buffer submitted before it. Thread-safe. */
+    void submit(Buffer* b);
+
+    /** release — Return an unused buffer. Thread-safe. */
+    void release(Buffer* b);
+
+    /** close — Write everything queued, sync, stop the thread; false after any error. */
+    bool close();
+
+    bool        ok() const;
+    std::string error() const;
+    const char* engine() const;   // "io_uring" or "pwrite"
+
+    uint64_t bytesWritten() const { return written_.load(std::memory_order_relaxed); }
+    uint64_t durableBytes() const { return durable_.load(std::memory_order_relaxed); }
+    uint64_t writes() const       { return writes_.load(std::memory_order_relaxed); }
+    uint64_t syncs() const        { return syncs_.load(std::memory_order_relaxed); }
+    uint64_t stalls() const       { return stalls_.load(std::memory_order_relaxed); }   // acquire() waits
+
+private:
+    void run();
+    void runRing(UringRing& ring);
+    void runPwrite();
+    void fail(const std::string& what);
+    void recycle(Buffer* b);
+
+    Options                 options_;
+    int                     fd_      = -1;
+    int                     wakeFd_  = -1;   // eventfd: producers wake the io_uring thread
+    bool                    useRing_ = false;
+    PageBuffer              memory_;
+    std::vector<Buffer>     pool_;
+
+    mutable std::mutex      mutex_;
+    std::condition_variable freed_;          // a buffer returned to free_
+    std::condition_variable queuedCv_;       // pwrite engine: work or close
+    std::vector<Buffer*>    free_;
+    std::deque<Buffer*>     queued_;
+    uint64_t                nextOffset_ = 0; // file offset of the next submitted buffer
+    uint64_t                logicalEnd_ = 0; // bytes submitted, without O_DIRECT padding
+    bool                    started_    = false;
+    bool                    closing_    = false;
+    bool                    closed_     = false;
+    std::string             error_;
+
+    std::atomic<uint64_t>   written_{0}, durable_{0}, writes_{0}, syncs_{0}, stalls_{0};
+    std::thread             thread_;
+};
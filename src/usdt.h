@@ -0,0 +1,34 @@
+// usdt.h — USDT (SystemTap/DTrace-style) static tracepoints
+//
+// Each POS_PROBEn() expands to a single NOP plus an ELF note describing where
+// its arguments live. Nothing runs until a tracer attaches, at which point
+// the kernel patches the NOP into a breakpoint — so the probes stay compiled
+// into production binaries and can be enabled on a running daemon:
+//
+//   bpftrace -l 'usdt:./pos_modern:pos:*'
+//   bpftrace -e 'usdt:./pos_modern:pos:batch__start { @s[arg0] = nsecs; }
+//                usdt:./pos_modern:pos:batch__end   /@s[arg0]/ {
+//                    @us = hist((nsecs - @s[arg0]) / 1000); delete(@s[arg0]); }'
+//
+// Probes need <sys/sdt.h> at build time (Debian/Ubuntu: systemtap-sdt-dev,
+// RHEL/Azure Linux: systemtap-sdt-devel). Without it, or when built with
+// -DPOS_NO_USDT (CMake: -DPOS_USDT=OFF), the macros compile to nothing.
+
+#pragma once
+
+#if !defined(POS_NO_USDT) && defined(__has_include)
+#  if __has_include(<sys/sdt.h>)
+#    include <sys/sdt.h>
+#    define POS_HAVE_USDT 1
+#  endif
+#endif
+
+#if defined(POS_HAVE_USDT)
+#  define POS_PROBE1(name, a)          STAP_PROBE1(pos, name, a)
+#  define POS_PROBE2(name, a, b)       STAP_PROBE2(pos, name, a, b)
+#  define POS_PROBE3(name, a, b, c)    STAP_PROBE3(pos, name, a, b, c)
+#else
+#  define POS_PROBE1(name, a)          ((void)0)
+#  define POS_PROBE2(name, a, b)       ((void)0)
+#  define POS_PROBE3(name, a, b, c)    ((void)0)
+#endif
@@ -0,0 +1,137 @@
+// zoned_decimal.cpp — Multi-versioned zoned-decimal column decoder
+//
+// decodeZonedBatch decodes one zoned field per record, across a batch. On
+// x86-64-v2 and later each field of up to 16 digits is one 16-byte load
+// ending at the field's last byte, and all of its checks and arithmetic are
+// vector operations:
+//
+//   range checks   every zone but the last is F, every digit nibble <= 9
+//                  (pmaxub/pcmpeqb against a lane mask of the field)
+//   digits → int   pmaddubsw (×10,1) → pmaddwd (×100,1) → packusdw →
+//                  pmaddwd (×10000,1) gives two 8-digit halves, combined as
+//                  hi·10^8 + lo
+//
+// Only the sign zone of the last byte is inspected as a scalar. Fields of
+// 17–18 digits, and the first records of a batch whose 16-byte window would
+// start before `in`, take the scalar decodeZoned.
+
+#include "ebcdic.h"
+
+#include <cstring>
+
+#include "multiversion.h"
+
+#if defined(POS_HAVE_MULTIVERSION)
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void storeValue(char* out, int64_t v) { std::memcpy(out, &v, sizeof(v)); }
+
+/** decodeScalar — decodeZoned per record; the default body and the fallback. */
+[[gnu::always_inline]] inline std::size_t decodeScalar(const char* in, std::size_t inStride,
+                                                       std::size_t width, std::size_t begin,
+                                                       std::size_t end, char* out,
+                                                       std::size_t outStride) {
+    std::size_t bad = 0;
+    for (std::size_t i = begin; i < end; ++i) {
+        int64_t v;
+        if (!decodeZoned(in + i * inStride, width, v)) {
+            v = 0;
+            ++bad;
+        }
+        storeValue(out + i * outStride, v);
+    }
+    return bad;
+}
+
+#if defined(POS_HAVE_MULTIVERSION)
+// Lanes [16 - w, 16) of a right-aligned window: load 16 bytes at kLanes + w
+alignas(16) constexpr unsigned char kLanes[33] = {
+    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF,
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0};
+
+/**
+ * decodeSse — The vector body (SSE4.1), inlined into each v2/v3/v4 version
+ * so v3/v4 get the VEX encoding.
+ */
+POS_TARGET("sse4.1") [[gnu::always_inline]] inline std::size_t decodeSse(const char* in, std::size_t inStride,
+                                                    std::size_t width, std::size_t count,
+                                                    char* out, std::size_t outStride) {
+    if (width > 16) return decodeScalar(in, inStride, width, 0, count, out, outStride);
+
+    // Records whose window [field + width - 16, field + width) starts before `in`
+    std::size_t first = 0;
+    while (first < count && first * inStride + width < 16) ++first;
+    std::size_t bad = decodeScalar(in, inStride, width, 0, first, out, outStride);
+
+    const __m128i field  = _mm_loadu_si128(reinterpret_cast<const __m128i*>(kLanes + width));
+    const __m128i zoned  = _mm_andnot_si128(_mm_setr_epi8(0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, -1),
+                                            field);                     // all but the sign byte
+    const __m128i zoneF  = _mm_and_si128(zoned, _mm_set1_epi8(static_cast<char>(0xF0)));
+    const __m128i nibble = _mm_set1_epi8(0x0F);
+    const __m128i nine   = _mm_set1_epi8(9);
+    const __m128i w10    = _mm_setr_epi8(10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1, 10, 1);
+    const __m128i w100   = _mm_setr_epi16(100, 1, 100, 1, 100, 1, 100, 1);
+    const __m128i w10k   = _mm_setr_epi16(10000, 1, 10000, 1, 10000, 1, 10000, 1);
+
+    for (std::size_t i = first; i < count; ++i) {
+        const char* end = in + i * inStride + width;
+        const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(end - 16));
+
+        // Range checks: zones F (except the sign byte), digits 0–9
+        const __m128i d       = _mm_and_si128(_mm_and_si128(b, nibble), field);
+        const __m128i zoneBad = _mm_xor_si128(_mm_and_si128(b, zoneF), zoneF);
+        const __m128i digitOk = _mm_cmpeq_epi8(_mm_max_epu8(d, nine), nine);
+        const unsigned sign   = static_cast<unsigned char>(end[-1]) >> 4;
+        const bool ok = _mm_testz_si128(zoneBad, zoneBad) && _mm_movemask_epi8(digitOk) == 0xFFFF
+                        && sign >= 0xA;
+
+        // 16 digits → 8 × 2 → 4 × 4 → 2 × 8
+        const __m128i t2 = _mm_madd_epi16(_mm_maddubs_epi16(d, w10), w100);
+        const __m128i t4 = _mm_madd_epi16(_mm_packus_epi32(t2, t2), w10k);
+        const uint64_t halves = static_cast<uint64_t>(_mm_cvtsi128_si64(t4));
+        const int64_t  mag = static_cast<int64_t>((halves & 0xFFFFFFFF) * 100000000 + (halves >> 32));
+
+        const int64_t v = !ok ? 0 : (sign == 0xD || sign == 0xB) ? -mag : mag;
+        bad += !ok;
+        storeValue(out + i * outStride, v);
+    }
+    return bad;
+}
+#endif
+
+POS_TARGET("default")
+std::size_t decodeZonedImpl(const char* in, std::size_t inStride, std::size_t width,
+                            std::size_t count, char* out, std::size_t outStride) {
+    return decodeScalar(in, inStride, width, 0, count, out, outStride);
+}
+
+#if defined(POS_HAVE_MULTIVERSION)
+POS_TARGET("arch=x86-64-v2")
+std::size_t decodeZonedImpl(const char* in, std::size_t inStride, std::size_t width,
+                            std::size_t count, char* out, std::size_t outStride) {
+    return decodeSse(in, inStride, width, count, out, outStride);
+}
+
+POS_TARGET("arch=x86-64-v3")
+std::size_t decodeZonedImpl(const char* in, std::size_t inStride, std::size_t width,
+                            std::size_t count, char* out, std::size_t outStride) {
+    return decodeSse(in, inStride, width, count, out, outStride);
+}
+
+POS_TARGET("arch=x86-64-v4")
+std::size_t decodeZonedImpl(const char* in, std::size_t inStride, std::size_t width,
+                            std::size_t count, char* out, std::size_t outStride) {
+    return decodeSse(in, inStride, width, count, out, outStride);
+}
+#endif
+
+}  // namespace
+
+std::size_t decodeZonedBatch(const char* in, std::size_t inStride, std::size_t width,
+                             std::size_t count, char* out, std::size_t outStride) {
+    return decodeZonedImpl(in, inStride, width, count, out, outStride);
+}